@@ -58,7 +58,8 @@ private:
 
 bool ATSCollectionVisitor::VisitMemberExpr(MemberExpr *ME)
 {
-  if (ConsumerInstance->isInIncludedFile(ME))
+  if (ConsumerInstance->isInIncludedFile(ME) ||
+      ConsumerInstance->isOutsideRegions(ME))
     return true;
 
   ValueDecl *OrigDecl = ME->getMemberDecl();
@@ -86,7 +87,8 @@ bool ATSCollectionVisitor::VisitMemberExpr(MemberExpr *ME)
 
 bool ATSCollectionVisitor::VisitArraySubscriptExpr(ArraySubscriptExpr *ASE)
 {
-  if (ConsumerInstance->isInIncludedFile(ASE))
+  if (ConsumerInstance->isInIncludedFile(ASE) ||
+      ConsumerInstance->isOutsideRegions(ASE))
     return true;
 
   const Type *T = ASE->getType().getTypePtr();
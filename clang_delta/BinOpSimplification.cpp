@@ -65,6 +65,7 @@ private:
 bool BSCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
   if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD) ||
       !FD->isThisDeclarationADefinition())
     return true;
 
@@ -55,7 +55,8 @@ private:
 
 bool CallExprToValueVisitor::VisitCallExpr(CallExpr *CE)
 {
-  if (ConsumerInstance->isInIncludedFile(CE))
+  if (ConsumerInstance->isInIncludedFile(CE) ||
+      ConsumerInstance->isOutsideRegions(CE))
     return true;
 
   ConsumerInstance->ValidInstanceNum++;
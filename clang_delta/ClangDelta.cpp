@@ -47,7 +47,8 @@ static void PrintHelpMessage()
   llvm::outs() << "--transformation=<name> ";
   llvm::outs() << "--counter=<number> ";
   llvm::outs() << "--output=<output_filename> ";
-  llvm::outs() << "<source_filename>\n\n";
+  llvm::outs() << "<source_filename> ";
+  llvm::outs() << "[-- <compiler_flags>]\n\n";
 
   llvm::outs() << "clang_delta options:\n";
 
@@ -63,6 +64,16 @@ static void PrintHelpMessage()
   llvm::outs() << "  --transformation=<name>: ";
   llvm::outs() << "specify the transformation\n";
 
+  llvm::outs() << "  --pipeline=<name>,<name>,...: ";
+  llvm::outs() << "apply the given transformations one after another, each ";
+  llvm::outs() << "one to the output of the previous one, parsing the ";
+  llvm::outs() << "source file only in memory after the first step; the ";
+  llvm::outs() << "counter is used for every step, and the output of each ";
+  llvm::outs() << "step which changes the source is written to ";
+  llvm::outs() << "<output_filename>.<step number>; the steps which fail ";
+  llvm::outs() << "are listed on stderr and make the pipeline exit with ";
+  llvm::outs() << "code 4\n";
+
   llvm::outs() << "  --transformations: ";
   llvm::outs() << "print the names of all available transformations\n";
 
@@ -105,6 +116,35 @@ static void PrintHelpMessage()
   llvm::outs() << "specify C++ standard used (c++98, c++11, c++14, c++17, c++20) ";
   llvm::outs() << "\n";
 
+  llvm::outs() << "  --compile-commands=<filename>: ";
+  llvm::outs() << "parse the source file with the flags of its entry in ";
+  llvm::outs() << "the given compile_commands.json (or the one in the given ";
+  llvm::outs() << "directory); the entry of a file with the same name is ";
+  llvm::outs() << "used if there is none for the source file itself";
+  llvm::outs() << "\n";
+
+  llvm::outs() << "  -- <compiler_flags>: ";
+  llvm::outs() << "parse the source file with the given clang driver flags ";
+  llvm::outs() << "(after the ones from --compile-commands)";
+  llvm::outs() << "\n";
+
+  llvm::outs() << "  --region=<offset>:<length>: ";
+  llvm::outs() << "only consider the transformation instances in the given ";
+  llvm::outs() << "byte range of the source file (can be given several ";
+  llvm::outs() << "times, but not with --pipeline)";
+  llvm::outs() << "\n";
+
+  llvm::outs() << "  --ast-cache=<directory>: ";
+  llvm::outs() << "save the parsed source file into the given directory, ";
+  llvm::outs() << "and load it from there instead of parsing a source file ";
+  llvm::outs() << "with the same content, included files and flags again";
+  llvm::outs() << "\n";
+
+  llvm::outs() << "  --ast-cache-size=<megabytes>: ";
+  llvm::outs() << "remove the least recently used files of the AST cache ";
+  llvm::outs() << "when it grows larger than the given size (default: 1024)";
+  llvm::outs() << "\n";
+
   llvm::outs() << "  --report-instances-count: ";
   llvm::outs() << "report number of transformation instances on stderr ";
   llvm::outs() << "\n";
@@ -147,6 +187,11 @@ static void HandleOneArgValue(const std::string &ArgValueStr, size_t SepPos)
       Die("Invalid transformation[" + ArgValue + "]");
     }
   }
+  else if (!ArgName.compare("pipeline")) {
+    if (TransMgr->setPipeline(ArgValue)) {
+      Die("Invalid pipeline[" + ArgValue + "]");
+    }
+  }
   else if (!ArgName.compare("query-instances")) {
     if (TransMgr->setTransformation(ArgValue)) {
       Die("Invalid transformation[" + ArgValue + "]");
@@ -191,6 +236,33 @@ static void HandleOneArgValue(const std::string &ArgValueStr, size_t SepPos)
   else if (!ArgName.compare("std")) {
     TransMgr->setCXXStandard(ArgValue);
   }
+  else if (!ArgName.compare("compile-commands")) {
+    TransMgr->setCompileCommandsFileName(ArgValue);
+  }
+  else if (!ArgName.compare("ast-cache")) {
+    TransMgr->setASTCacheDir(ArgValue);
+  }
+  else if (!ArgName.compare("ast-cache-size")) {
+    unsigned long long Val;
+    std::stringstream TmpSS(ArgValue);
+
+    if (!(TmpSS >> Val) || !TmpSS.eof())
+      Die("Invalid AST cache size[" + ArgValueStr + "]");
+
+    TransMgr->setASTCacheSize(Val * 1024 * 1024);
+  }
+  else if (!ArgName.compare("region")) {
+    unsigned Offset, Length;
+    char Sep;
+    std::stringstream TmpSS(ArgValue);
+
+    if (!(TmpSS >> Offset >> Sep >> Length) || (Sep != ':') ||
+        !TmpSS.eof()) {
+      Die("Invalid region[" + ArgValueStr + "]");
+    }
+
+    TransMgr->addRegion(Offset, Length);
+  }
   else {
     DieOnBadCmdArg("--" + ArgValueStr);
   }
@@ -252,6 +324,12 @@ int main(int argc, char **argv)
 {
   TransMgr = TransformationManager::GetInstance();
   for (int i = 1; i < argc; i++) {
+    // everything after "--" is passed to the clang driver
+    if (!std::string(argv[i]).compare("--")) {
+      for (i++; i < argc; i++)
+        TransMgr->addCompilerArg(argv[i]);
+      break;
+    }
     HandleOneArg(argv[i]);
   }
 
@@ -259,6 +337,13 @@ int main(int argc, char **argv)
   if (!TransMgr->verify(ErrorMsg, ErrorCode))
     Die(ErrorMsg);
 
+  if (TransMgr->isPipeline()) {
+    if (!TransMgr->doPipeline(ErrorMsg, ErrorCode))
+      Die(ErrorMsg);
+    TransformationManager::Finalize();
+    return 0;
+  }
+
   if (!TransMgr->initializeCompilerInstance(ErrorMsg))
     Die(ErrorMsg);
 
@@ -142,7 +142,8 @@ bool TemplateParameterTypeVisitor::isAUsedParameter(NamedDecl *ND)
 bool ClassTemplateToClassASTVisitor::VisitClassTemplateDecl(
        ClassTemplateDecl *D)
 {
-  if (ConsumerInstance->isInIncludedFile(D))
+  if (ConsumerInstance->isInIncludedFile(D) ||
+      ConsumerInstance->isOutsideRegions(D))
     return true;
 
   ClassTemplateDecl *CanonicalD = D->getCanonicalDecl();
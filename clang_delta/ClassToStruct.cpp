@@ -51,6 +51,9 @@ bool ClassToStructVisitor::VisitCXXRecordDecl(
   if (!definition
       || !definition->isClass())
     return true;
+  if (ConsumerInstance->isInIncludedFile(definition) ||
+      ConsumerInstance->isOutsideRegions(definition))
+    return true;
 
   ConsumerInstance->CXXRDDefSet.insert(definition);
   return true;
@@ -0,0 +1,34 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012, 2013, 2014, 2015, 2016, 2017, 2018 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "RemoveBaseClass.h"
+
+#include "TransformationManager.h"
+
+static const char* DescriptionMsg =
+"This pass collapses the whole inheritance hierarchy of a class into \
+the class itself if \n\
+  * none of the classes in the hierarchy is a template; \n\
+  * and all the base classes are defined in the same scope. \n\
+The members of all the transitive base classes are copied into the \
+derived class, except for the ones hidden or overridden by a nearer class, \
+the base classes are removed, and all references to them, including \
+qualified names and casts, are replaced with the derived class. \n";
+
+static RegisterTransformation<RemoveBaseClass, RemoveBaseClass::EMode>
+         Trans("collapse-class-hierarchy", DescriptionMsg,
+               RemoveBaseClass::EMode::Collapse);
+
+
+// Implementation is in RemoveBaseClass.cpp
@@ -53,7 +53,7 @@ bool CombineGlobalVarDecl::HandleTopLevelDecl(DeclGroupRef DGR)
 {
   DeclGroupRef::iterator DI = DGR.begin();
   VarDecl *VD = dyn_cast<VarDecl>(*DI);
-  if (!VD || isInIncludedFile(VD))
+  if (!VD || isInIncludedFile(VD) || isOutsideRegions(VD))
     return true;
   SourceRange Range = VD->getSourceRange();
   if (Range.getBegin().isInvalid() || Range.getEnd().isInvalid())
@@ -85,7 +85,8 @@ const Type *CombLocalVarCollectionVisitor::getTypeFromDeclStmt(DeclStmt *DS)
 
 bool CombLocalVarCollectionVisitor::VisitCompoundStmt(CompoundStmt *CS)
 {
-  if (ConsumerInstance->isInIncludedFile(CS))
+  if (ConsumerInstance->isInIncludedFile(CS) ||
+      ConsumerInstance->isOutsideRegions(CS))
     return true;
 
   ConsumerInstance->DeclStmts.clear();
@@ -24,7 +24,7 @@ template<typename T>
 class CommonRenameClassRewriteVisitor : public RecursiveASTVisitor<T> {
 public:
   CommonRenameClassRewriteVisitor(Transformation *Instance,
-                                  Rewriter *RT,
+                                  EditRewriter *RT,
                                   RewriteUtils *Helper,
                                   const CXXRecordDecl *CXXRD,
                                   const std::string &Name)
@@ -37,6 +37,11 @@ public:
 
   T &getDerived() { return *static_cast<T*>(this); };
 
+  // Rename CXXRD to the same new name as well
+  void addCXXRecordDecl(const CXXRecordDecl *CXXRD) {
+    OtherCXXRecordDecls.insert(CXXRD->getCanonicalDecl());
+  }
+
   bool VisitCXXRecordDecl(CXXRecordDecl *CXXRD);
 
   bool VisitCXXConstructorDecl(CXXConstructorDecl *CtorDecl);
@@ -70,6 +75,8 @@ public:
 private:
   typedef llvm::SmallPtrSet<void *, 20> LocPtrSet;
 
+  typedef llvm::SmallPtrSet<const CXXRecordDecl *, 8> CXXRecordDeclSet;
+
   void renameTemplateName(TemplateName TmplName, SourceLocation LocStart);
 
   bool getNewName(const CXXRecordDecl *CXXRD, std::string &NewName);
@@ -80,12 +87,14 @@ private:
 
   Transformation *ConsumerInstance;
 
-  Rewriter *TheRewriter;
+  EditRewriter *TheRewriter;
 
   RewriteUtils *RewriteHelper;
 
   const CXXRecordDecl *TheCXXRecordDecl;
 
+  CXXRecordDeclSet OtherCXXRecordDecls;
+
   std::string NewNameStr;
 };
 
@@ -454,7 +463,8 @@ bool CommonRenameClassRewriteVisitor<T>::getNewName(const CXXRecordDecl *CXXRD,
                              std::string &NewName)
 {
   const CXXRecordDecl *CanonicalRD = CXXRD->getCanonicalDecl();
-  if (CanonicalRD == TheCXXRecordDecl) {
+  if (CanonicalRD == TheCXXRecordDecl ||
+      OtherCXXRecordDecls.count(CanonicalRD)) {
     NewName = NewNameStr;
     return true;
   }
@@ -472,10 +482,14 @@ bool CommonRenameClassRewriteVisitor<T>::getNewNameByName(
     NewName = NewNameStr;
     return true;
   }
-  else {
-    NewName = "";
-    return false;
+  for (const CXXRecordDecl *CXXRD : OtherCXXRecordDecls) {
+    if (Name == CXXRD->getNameAsString()) {
+      NewName = NewNameStr;
+      return true;
+    }
   }
+  NewName = "";
+  return false;
 }
 
 } // end namespace clang_delta_common_visitor
@@ -444,7 +444,8 @@ bool CopyPropagation::hasSameStringRep(const Expr *CopyE,
 void CopyPropagation::addOneDominatedExpr(const Expr *CopyE,
                                           const Expr *DominatedE)
 {
-  if (isInIncludedFile(CopyE) || isInIncludedFile(DominatedE))
+  if (isInIncludedFile(CopyE) || isInIncludedFile(DominatedE) ||
+      isOutsideRegions(CopyE) || isOutsideRegions(DominatedE))
     return;
 
   if ((CopyE == DominatedE) || isRefToTheSameVar(CopyE, DominatedE) ||
@@ -0,0 +1,386 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012, 2013, 2015, 2017, 2019 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "DesugarTypedef.h"
+
+#include <cstring>
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
+
+#include "TransformationManager.h"
+
+using namespace clang;
+
+static const char *DescriptionMsg =
+"This pass replaces all the uses of a typedef or an alias declaration \
+with its fully desugared type, and removes the declaration. \
+The underlying type must be a builtin, enum or class type, or a pointer \
+or reference to one, so that its spelling can replace the typedef name \
+anywhere. A --to-counter range desugars several typedefs in one run. \n";
+
+static RegisterTransformation<DesugarTypedef>
+         Trans("desugar-typedef", DescriptionMsg);
+
+class DesugarTypedefCollectionVisitor : public
+  RecursiveASTVisitor<DesugarTypedefCollectionVisitor> {
+
+public:
+  explicit DesugarTypedefCollectionVisitor(DesugarTypedef *Instance)
+    : ConsumerInstance(Instance)
+  { }
+
+  bool VisitTypedefNameDecl(TypedefNameDecl *D);
+
+  bool VisitDeclaratorDecl(DeclaratorDecl *D);
+
+  bool VisitElaboratedTypeLoc(ElaboratedTypeLoc Loc);
+
+  bool VisitTypedefTypeLoc(TypedefTypeLoc Loc);
+
+  bool VisitQualifiedTypeLoc(QualifiedTypeLoc Loc);
+
+  bool VisitCXXFunctionalCastExpr(CXXFunctionalCastExpr *E);
+
+  bool VisitCXXTemporaryObjectExpr(CXXTemporaryObjectExpr *E);
+
+  bool VisitCXXScalarValueInitExpr(CXXScalarValueInitExpr *E);
+
+  bool VisitUsingShadowDecl(UsingShadowDecl *D);
+
+private:
+  DesugarTypedef *ConsumerInstance;
+};
+
+bool DesugarTypedefCollectionVisitor::VisitTypedefNameDecl(TypedefNameDecl *D)
+{
+  ConsumerInstance->DeclBeginLocs[D->getBeginLoc().getPtrEncoding()]++;
+  ConsumerInstance->addTypeBeginLoc(D->getTypeSourceInfo());
+  if (D->isCanonicalDecl())
+    ConsumerInstance->handleOneTypedefDecl(D);
+  return true;
+}
+
+bool DesugarTypedefCollectionVisitor::VisitDeclaratorDecl(DeclaratorDecl *D)
+{
+  if (!D->isImplicit())
+    ConsumerInstance->addTypeBeginLoc(D->getTypeSourceInfo());
+  return true;
+}
+
+// Handle qualified uses, e.g., S::Int, which are replaced as a whole
+bool DesugarTypedefCollectionVisitor::VisitElaboratedTypeLoc(
+       ElaboratedTypeLoc Loc)
+{
+  TypeLoc NamedLoc = Loc.getNamedTypeLoc();
+  if (!NamedLoc.getAs<TypedefTypeLoc>())
+    return true;
+
+  void *LocPtr = NamedLoc.getBeginLoc().getPtrEncoding();
+  if (!ConsumerInstance->VisitedLocs.insert(LocPtr).second)
+    return true;
+  ConsumerInstance->handleOneUse(NamedLoc, Loc.getSourceRange());
+  return true;
+}
+
+bool DesugarTypedefCollectionVisitor::VisitTypedefTypeLoc(TypedefTypeLoc Loc)
+{
+  // Avoid duplicated uses from the same DeclGroup, e.g., T t1, t2;
+  void *LocPtr = Loc.getBeginLoc().getPtrEncoding();
+  if (!ConsumerInstance->VisitedLocs.insert(LocPtr).second)
+    return true;
+  ConsumerInstance->handleOneUse(Loc, Loc.getSourceRange());
+  return true;
+}
+
+bool DesugarTypedefCollectionVisitor::VisitQualifiedTypeLoc(
+       QualifiedTypeLoc Loc)
+{
+  ConsumerInstance->invalidateQualifiedTypedef(Loc.getUnqualifiedLoc());
+  return true;
+}
+
+bool DesugarTypedefCollectionVisitor::VisitCXXFunctionalCastExpr(
+       CXXFunctionalCastExpr *E)
+{
+  if (const TypedefNameDecl *D = ConsumerInstance->getTypedefDecl(
+        E->getTypeInfoAsWritten()->getTypeLoc()))
+    ConsumerInstance->CastTypedefDecls.insert(D);
+  return true;
+}
+
+bool DesugarTypedefCollectionVisitor::VisitCXXTemporaryObjectExpr(
+       CXXTemporaryObjectExpr *E)
+{
+  if (const TypedefNameDecl *D = ConsumerInstance->getTypedefDecl(
+        E->getTypeSourceInfo()->getTypeLoc()))
+    ConsumerInstance->CastTypedefDecls.insert(D);
+  return true;
+}
+
+bool DesugarTypedefCollectionVisitor::VisitCXXScalarValueInitExpr(
+       CXXScalarValueInitExpr *E)
+{
+  TypeSourceInfo *TSI = E->getTypeSourceInfo();
+  if (!TSI)
+    return true;
+  if (const TypedefNameDecl *D =
+        ConsumerInstance->getTypedefDecl(TSI->getTypeLoc()))
+    ConsumerInstance->CastTypedefDecls.insert(D);
+  return true;
+}
+
+// A typedef named by a using declaration must stay
+bool DesugarTypedefCollectionVisitor::VisitUsingShadowDecl(UsingShadowDecl *D)
+{
+  if (const TypedefNameDecl *TD =
+        dyn_cast<TypedefNameDecl>(D->getTargetDecl()))
+    ConsumerInstance->InvalidTypedefDecls.insert(TD->getCanonicalDecl());
+  return true;
+}
+
+void DesugarTypedef::Initialize(ASTContext &context)
+{
+  Transformation::Initialize(context);
+  CollectionVisitor = new DesugarTypedefCollectionVisitor(this);
+}
+
+void DesugarTypedef::HandleTranslationUnit(ASTContext &Ctx)
+{
+  CollectionVisitor->TraverseDecl(Ctx.getTranslationUnitDecl());
+
+  sortBySourceOrder(AllTypedefDecls);
+  for (const TypedefNameDecl *D : AllTypedefDecls) {
+    if (isValidTypedefDecl(D))
+      ValidTypedefDecls.push_back(D);
+  }
+  ValidInstanceNum = ValidTypedefDecls.size();
+
+  if (QueryInstanceOnly)
+    return;
+
+  if (TransformationCounter > ValidInstanceNum) {
+    TransError = TransMaxInstanceError;
+    return;
+  }
+  if (ToCounter > ValidInstanceNum) {
+    TransError = TransToCounterTooBigError;
+    return;
+  }
+
+  Ctx.getDiagnostics().setSuppressAllDiagnostics(false);
+
+  doRewriting();
+
+  if (Ctx.getDiagnostics().hasErrorOccurred() ||
+      Ctx.getDiagnostics().hasFatalErrorOccurred())
+    TransError = TransInternalError;
+}
+
+const TypedefNameDecl *DesugarTypedef::getTypedefDecl(TypeLoc Loc)
+{
+  if (ElaboratedTypeLoc ETLoc = Loc.getAs<ElaboratedTypeLoc>())
+    Loc = ETLoc.getNamedTypeLoc();
+  TypedefTypeLoc TTLoc = Loc.getAs<TypedefTypeLoc>();
+  if (!TTLoc)
+    return NULL;
+  return TTLoc.getTypedefNameDecl()->getCanonicalDecl();
+}
+
+void DesugarTypedef::handleOneUse(TypeLoc Loc, SourceRange Range)
+{
+  const TypedefNameDecl *D = getTypedefDecl(Loc);
+  if (!D)
+    return;
+
+  if (Range.getBegin().isMacroID() || Range.getEnd().isMacroID() ||
+      isInIncludedFile(Range))
+    InvalidTypedefDecls.insert(D);
+  else
+    TypedefToUses[D].push_back(Range);
+}
+
+void DesugarTypedef::addTypeBeginLoc(const TypeSourceInfo *TSI)
+{
+  if (TSI)
+    TypeBeginLocs[TSI->getTypeLoc().getBeginLoc().getPtrEncoding()]++;
+}
+
+bool DesugarTypedef::isPointerTypedef(const TypedefNameDecl *D)
+{
+  QualType QT = D->getUnderlyingType();
+  return QT->isPointerType() || QT->isReferenceType() ||
+         QT->isMemberPointerType();
+}
+
+// The desugared spelling can't take the qualifiers of a pointer typedef,
+// e.g., const T with T being int * is not const int *
+void DesugarTypedef::invalidateQualifiedTypedef(TypeLoc Loc)
+{
+  const TypedefNameDecl *D = getTypedefDecl(Loc);
+  if (D && isPointerTypedef(D))
+    InvalidTypedefDecls.insert(D);
+}
+
+// The spelling of QT must be valid wherever the typedef is used, so the
+// base type must be a builtin type or a named, accessible enum or class
+bool DesugarTypedef::isValidUnderlyingType(QualType QT)
+{
+  QT = Context->getCanonicalType(QT);
+  while (QT->isPointerType() || QT->isReferenceType())
+    QT = QT->getPointeeType();
+
+  const Type *Ty = QT.getTypePtr();
+  if (isa<BuiltinType>(Ty))
+    return true;
+
+  const TagType *TT = dyn_cast<TagType>(Ty);
+  if (!TT)
+    return false;
+  const TagDecl *TD = TT->getDecl();
+  if (!TD->getIdentifier() || TD->getParentFunctionOrMethod())
+    return false;
+  for (const Decl *D = TD; isa<RecordDecl>(D->getDeclContext());
+       D = cast<Decl>(D->getDeclContext())) {
+    if (D->getAccess() != AS_public)
+      return false;
+  }
+  return true;
+}
+
+void DesugarTypedef::handleOneTypedefDecl(const TypedefNameDecl *D)
+{
+  // omit the typedefs injected by Clang
+  if (D->isImplicit() || D->getBeginLoc().isInvalid() || isInIncludedFile(D) ||
+      isOutsideRegions(D))
+    return;
+
+  QualType QT = D->getUnderlyingType();
+  if (D->getDeclContext()->isDependentContext() || QT->isDependentType() ||
+      !isValidUnderlyingType(QT))
+    return;
+
+  PrintingPolicy Policy = getPrintingPolicy();
+  Policy.SuppressUnwrittenScope = true;
+  TypedefToStr[D] = Context->getCanonicalType(QT).getAsString(Policy);
+  AllTypedefDecls.push_back(D);
+}
+
+bool DesugarTypedef::ownsTagDecl(const TypedefNameDecl *D)
+{
+  const ElaboratedType *ETy =
+    dyn_cast<ElaboratedType>(D->getUnderlyingType().getTypePtr());
+  return ETy && ETy->getOwnedTagDecl();
+}
+
+bool DesugarTypedef::isValidTypedefDecl(const TypedefNameDecl *D)
+{
+  if (InvalidTypedefDecls.count(D))
+    return false;
+
+  // the declarator of a pointer typedef only applies to the first of
+  // several declarators, e.g., T a, b; with T being int * is not int *a, b;
+  if (isPointerTypedef(D)) {
+    for (SourceRange Range : TypedefToUses[D]) {
+      if (TypeBeginLocs[Range.getBegin().getPtrEncoding()] > 1)
+        return false;
+    }
+  }
+
+  for (const TypedefNameDecl *Redecl : D->redecls()) {
+    SourceLocation Loc = Redecl->getBeginLoc();
+    if (isInIncludedFile(Redecl) || Loc.isMacroID() ||
+        DeclBeginLocs[Loc.getPtrEncoding()] > 1)
+      return false;
+    // typedef struct S { ... } T; keeps the definition of S
+    if (ownsTagDecl(Redecl) &&
+        (isa<TypeAliasDecl>(Redecl) ||
+         strncmp(SrcManager->getCharacterData(Loc), "typedef", 7)))
+      return false;
+  }
+
+  // a multi-word type can't be used in a functional cast, e.g.,
+  // unsigned int(1)
+  const std::string &Str = TypedefToStr[D];
+  return !CastTypedefDecls.count(D) ||
+         Str.find_first_of(" *&") == std::string::npos;
+}
+
+bool DesugarTypedef::isCoveredByEdit(SourceRange Range)
+{
+  for (SourceRange Covering : CoveringRanges) {
+    if (Covering == Range)
+      continue;
+    if (!SrcManager->isBeforeInTranslationUnit(Range.getBegin(),
+                                               Covering.getBegin()) &&
+        !SrcManager->isBeforeInTranslationUnit(Covering.getEnd(),
+                                               Range.getEnd()))
+      return true;
+  }
+  return false;
+}
+
+void DesugarTypedef::desugarTypedef(const TypedefNameDecl *D)
+{
+  const std::string &Str = TypedefToStr[D];
+  for (SourceRange Range : TypedefToUses[D]) {
+    if (!isCoveredByEdit(Range))
+      TheRewriter.ReplaceText(Range, Str);
+  }
+
+  for (const TypedefNameDecl *Redecl : D->redecls()) {
+    if (!ownsTagDecl(Redecl)) {
+      RewriteHelper->removeTextUntil(Redecl->getSourceRange(), ';');
+      continue;
+    }
+
+    // typedef struct S { ... } T;  ==>  struct S { ... } ;
+    SourceLocation StartLoc = Redecl->getBeginLoc();
+    SourceLocation EndLoc =
+      RewriteHelper->getLocationAfterSkiping(StartLoc.getLocWithOffset(7),
+                                             ' ');
+    TheRewriter.RemoveText(CharSourceRange::getCharRange(StartLoc, EndLoc));
+    TheRewriter.RemoveText(SourceRange(Redecl->getLocation()));
+  }
+}
+
+void DesugarTypedef::doRewriting(void)
+{
+  int LastCounter = (ToCounter > 0) ? ToCounter : TransformationCounter;
+  for (int I = TransformationCounter; I <= LastCounter; ++I) {
+    const TypedefNameDecl *D = ValidTypedefDecls[I-1];
+    const SourceRangeVector &Uses = TypedefToUses[D];
+    CoveringRanges.append(Uses.begin(), Uses.end());
+    for (const TypedefNameDecl *Redecl : D->redecls()) {
+      if (!ownsTagDecl(Redecl))
+        CoveringRanges.push_back(Redecl->getSourceRange());
+    }
+  }
+
+  if (ToCounter <= 0) {
+    desugarTypedef(ValidTypedefDecls[TransformationCounter - 1]);
+    return;
+  }
+
+  for (int I = ToCounter; I >= TransformationCounter; --I) {
+    TransAssert((I >= 1) && "Invalid Index!");
+    const TypedefNameDecl *D = ValidTypedefDecls[I-1];
+    rewriteInstanceSafely(I, [this, D]() { desugarTypedef(D); });
+  }
+}
+
+DesugarTypedef::~DesugarTypedef(void)
+{
+  delete CollectionVisitor;
+}
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012, 2013, 2015, 2017, 2019 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DESUGAR_TYPEDEF_H
+#define DESUGAR_TYPEDEF_H
+
+#include <string>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "Transformation.h"
+
+namespace clang {
+  class ASTContext;
+  class QualType;
+  class TypeLoc;
+  class TypeSourceInfo;
+  class TypedefNameDecl;
+}
+
+class DesugarTypedefCollectionVisitor;
+
+class DesugarTypedef : public Transformation {
+friend class DesugarTypedefCollectionVisitor;
+
+public:
+  DesugarTypedef(const char *TransName, const char *Desc)
+    : Transformation(TransName, Desc, /*MultipleRewrites*/true),
+      CollectionVisitor(NULL)
+  { }
+
+  ~DesugarTypedef(void);
+
+private:
+  typedef llvm::SmallPtrSet<const clang::TypedefNameDecl *, 20>
+    TypedefDeclsSet;
+
+  typedef llvm::SmallVector<clang::SourceRange, 8> SourceRangeVector;
+
+  virtual void Initialize(clang::ASTContext &context);
+
+  virtual void HandleTranslationUnit(clang::ASTContext &Ctx);
+
+  void handleOneTypedefDecl(const clang::TypedefNameDecl *D);
+
+  void handleOneUse(clang::TypeLoc Loc, clang::SourceRange Range);
+
+  const clang::TypedefNameDecl *getTypedefDecl(clang::TypeLoc Loc);
+
+  void invalidateTypedef(clang::TypeLoc Loc);
+
+  void invalidateQualifiedTypedef(clang::TypeLoc Loc);
+
+  bool isPointerTypedef(const clang::TypedefNameDecl *D);
+
+  void addTypeBeginLoc(const clang::TypeSourceInfo *TSI);
+
+  bool isValidUnderlyingType(clang::QualType QT);
+
+  bool ownsTagDecl(const clang::TypedefNameDecl *D);
+
+  bool isValidTypedefDecl(const clang::TypedefNameDecl *D);
+
+  bool isCoveredByEdit(clang::SourceRange Range);
+
+  void desugarTypedef(const clang::TypedefNameDecl *D);
+
+  void doRewriting(void);
+
+  // Typedefs in source order, by their canonical declarations
+  llvm::SmallVector<const clang::TypedefNameDecl *, 20> AllTypedefDecls;
+
+  llvm::DenseMap<const clang::TypedefNameDecl *, SourceRangeVector>
+    TypedefToUses;
+
+  // Typedefs which can't be desugared because of one of their uses
+  TypedefDeclsSet InvalidTypedefDecls;
+
+  // Typedefs used as the type of a functional cast, e.g., T(1)
+  TypedefDeclsSet CastTypedefDecls;
+
+  llvm::SmallPtrSet<void *, 32> VisitedLocs;
+
+  // Number of declarations starting at a location, e.g., 2 for
+  // typedef int T1, *T2;
+  llvm::DenseMap<void *, unsigned> DeclBeginLocs;
+
+  // Number of declarators sharing the type specifier starting at a
+  // location, e.g., 2 for T a, b;
+  llvm::DenseMap<void *, unsigned> TypeBeginLocs;
+
+  llvm::SmallVector<const clang::TypedefNameDecl *, 20> ValidTypedefDecls;
+
+  llvm::DenseMap<const clang::TypedefNameDecl *, std::string> TypedefToStr;
+
+  // Ranges replaced or removed by the rewritten instances. A use inside
+  // another one, e.g., T1 in T1::T2, is rewritten with it.
+  SourceRangeVector CoveringRanges;
+
+  DesugarTypedefCollectionVisitor *CollectionVisitor;
+
+  // Unimplemented
+  DesugarTypedef(void);
+
+  DesugarTypedef(const DesugarTypedef &);
+
+  void operator=(const DesugarTypedef &);
+};
+
+#endif
@@ -0,0 +1,332 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012, 2013, 2014, 2015, 2016, 2018, 2019 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "EditRewriter.h"
+
+#include <cassert>
+#include "llvm/Support/raw_ostream.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/Lexer.h"
+
+using namespace clang;
+
+bool EditRewriter::getRangeOffsets(CharSourceRange Range, FileID &FID,
+                                   unsigned &Start, unsigned &End) const
+{
+  if (!isRewritable(Range.getBegin()) || !isRewritable(Range.getEnd()))
+    return false;
+
+  SourceManager &SM = getSourceMgr();
+  std::pair<FileID, unsigned> B = SM.getDecomposedLoc(Range.getBegin());
+  std::pair<FileID, unsigned> E = SM.getDecomposedLoc(Range.getEnd());
+  if (B.first != E.first)
+    return false;
+
+  FID = B.first;
+  Start = B.second;
+  End = E.second;
+  if (Range.isTokenRange())
+    End += Lexer::MeasureTokenLength(Range.getEnd(), SM, getLangOpts());
+  return End >= Start;
+}
+
+// Two non-empty ranges conflict if they overlap; they may be adjacent.
+// Anything else conflicts if it touches the other record, so that the
+// insertions at the boundaries of a replaced range are left to
+// clang::Rewriter. Insertions at the same offset are merged.
+bool EditRewriter::conflicts(FileID FID, const Edit &E) const
+{
+  std::map<FileID, EditList>::const_iterator FI = Edits.find(FID);
+  if (FI == Edits.end())
+    return false;
+
+  const EditList &List = FI->second;
+  unsigned End = E.Offset + E.Length;
+  // Only the record before E can reach into it
+  EditList::const_iterator I = List.lower_bound(E.Offset);
+  if (I != List.begin())
+    --I;
+  for (; I != List.end() && I->first <= End; ++I) {
+    const Edit &Other = I->second;
+    if (Other.IsInsertion && E.IsInsertion)
+      continue;
+    unsigned OtherEnd = Other.Offset + Other.Length;
+    if (Other.Length && E.Length) {
+      if (Other.Offset < End && E.Offset < OtherEnd)
+        return true;
+    }
+    else if (Other.Offset <= End && E.Offset <= OtherEnd) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool EditRewriter::addEdit(FileID FID, const Edit &E, bool InsertAfter)
+{
+  EditList &List = Edits[FID];
+  EditList::iterator I = List.find(E.Offset);
+  if (I == List.end()) {
+    if (Checkpointed) {
+      Undo U = {FID, E.Offset, true, ""};
+      UndoLog.push_back(U);
+    }
+    List.insert(std::make_pair(E.Offset, E));
+    return false;
+  }
+
+  assert(I->second.IsInsertion && E.IsInsertion && "Conflicting edits!");
+  if (Checkpointed) {
+    Undo U = {FID, E.Offset, false, I->second.Text};
+    UndoLog.push_back(U);
+  }
+  if (InsertAfter)
+    I->second.Text += E.Text;
+  else
+    I->second.Text.insert(0, E.Text);
+  return false;
+}
+
+void EditRewriter::materialize(void) const
+{
+  if (Materialized)
+    return;
+  Materialized = true;
+
+  // The records don't interact, so the order they are replayed in
+  // doesn't matter
+  Rewriter *RW = const_cast<EditRewriter *>(this);
+  SourceManager &SM = getSourceMgr();
+  for (std::map<FileID, EditList>::const_iterator FI = Edits.begin(),
+       FE = Edits.end(); FI != FE; ++FI) {
+    SourceLocation FileStart = SM.getLocForStartOfFile(FI->first);
+    for (EditList::const_iterator I = FI->second.begin(),
+         E = FI->second.end(); I != E; ++I) {
+      const Edit &Ed = I->second;
+      SourceLocation Loc = FileStart.getLocWithOffset(Ed.Offset);
+      if (Ed.IsInsertion)
+        RW->InsertText(Loc, Ed.Text);
+      else
+        RW->ReplaceText(Loc, Ed.Length, Ed.Text);
+    }
+  }
+  Edits.clear();
+}
+
+bool EditRewriter::overlapsEdits(const CharSourceRange &Range) const
+{
+  if (Materialized || Edits.empty())
+    return false;
+  // clang::Rewriter doesn't look at the edits of such ranges
+  if (!isRewritable(Range.getBegin()) || !isRewritable(Range.getEnd()))
+    return false;
+
+  FileID FID;
+  unsigned Start, End;
+  if (!getRangeOffsets(Range, FID, Start, End))
+    return true;
+  Edit E = {Start, End - Start, "", false};
+  return conflicts(FID, E);
+}
+
+bool EditRewriter::InsertText(SourceLocation Loc, StringRef Str,
+                              bool InsertAfter, bool indentNewLines)
+{
+  if (!isRewritable(Loc))
+    return true;
+
+  if (!Materialized && !indentNewLines) {
+    std::pair<FileID, unsigned> V = getSourceMgr().getDecomposedLoc(Loc);
+    Edit E = {V.second, 0, Str.str(), true};
+    if (!conflicts(V.first, E))
+      return addEdit(V.first, E, InsertAfter);
+  }
+
+  materialize();
+  return Rewriter::InsertText(Loc, Str, InsertAfter, indentNewLines);
+}
+
+bool EditRewriter::InsertTextAfterToken(SourceLocation Loc, StringRef Str)
+{
+  if (!isRewritable(Loc))
+    return true;
+
+  FileID FID;
+  unsigned Start, End;
+  if (!Materialized &&
+      getRangeOffsets(CharSourceRange::getTokenRange(Loc, Loc),
+                      FID, Start, End)) {
+    Edit Token = {Start, End - Start, "", false};
+    Edit E = {End, 0, Str.str(), true};
+    if (!conflicts(FID, Token) && !conflicts(FID, E))
+      return addEdit(FID, E, /*InsertAfter=*/true);
+  }
+
+  materialize();
+  return Rewriter::InsertTextAfterToken(Loc, Str);
+}
+
+bool EditRewriter::RemoveText(SourceLocation Start, unsigned Length,
+                              RewriteOptions opts)
+{
+  if (!isRewritable(Start))
+    return true;
+
+  if (!Materialized && !opts.RemoveLineIfEmpty) {
+    std::pair<FileID, unsigned> V = getSourceMgr().getDecomposedLoc(Start);
+    Edit E = {V.second, Length, "", false};
+    if (!conflicts(V.first, E))
+      return addEdit(V.first, E, /*InsertAfter=*/true);
+  }
+
+  materialize();
+  return Rewriter::RemoveText(Start, Length, opts);
+}
+
+bool EditRewriter::RemoveText(CharSourceRange range, RewriteOptions opts)
+{
+  if (!isRewritable(range.getBegin()))
+    return true;
+
+  FileID FID;
+  unsigned Start, End;
+  if (!Materialized && !opts.RemoveLineIfEmpty &&
+      getRangeOffsets(range, FID, Start, End)) {
+    Edit E = {Start, End - Start, "", false};
+    if (!conflicts(FID, E))
+      return addEdit(FID, E, /*InsertAfter=*/true);
+  }
+
+  materialize();
+  return Rewriter::RemoveText(range, opts);
+}
+
+bool EditRewriter::ReplaceText(SourceLocation Start, unsigned OrigLength,
+                               StringRef NewStr)
+{
+  if (!isRewritable(Start))
+    return true;
+
+  if (!Materialized) {
+    std::pair<FileID, unsigned> V = getSourceMgr().getDecomposedLoc(Start);
+    Edit E = {V.second, OrigLength, NewStr.str(), false};
+    if (!conflicts(V.first, E))
+      return addEdit(V.first, E, /*InsertAfter=*/true);
+  }
+
+  materialize();
+  return Rewriter::ReplaceText(Start, OrigLength, NewStr);
+}
+
+bool EditRewriter::ReplaceText(CharSourceRange range, StringRef NewStr)
+{
+  if (!isRewritable(range.getBegin()))
+    return true;
+
+  FileID FID;
+  unsigned Start, End;
+  if (!Materialized && getRangeOffsets(range, FID, Start, End)) {
+    Edit E = {Start, End - Start, NewStr.str(), false};
+    if (!conflicts(FID, E))
+      return addEdit(FID, E, /*InsertAfter=*/true);
+  }
+
+  materialize();
+  return Rewriter::ReplaceText(range, NewStr);
+}
+
+bool EditRewriter::ReplaceText(SourceRange range, SourceRange replacementRange)
+{
+  materialize();
+  return Rewriter::ReplaceText(range, replacementRange);
+}
+
+int EditRewriter::getRangeSize(const CharSourceRange &Range,
+                               RewriteOptions opts) const
+{
+  if (overlapsEdits(Range))
+    materialize();
+  return Rewriter::getRangeSize(Range, opts);
+}
+
+std::string EditRewriter::getRewrittenText(SourceRange Range) const
+{
+  if (overlapsEdits(CharSourceRange::getTokenRange(Range)))
+    materialize();
+  return Rewriter::getRewrittenText(Range);
+}
+
+const RewriteBuffer *EditRewriter::getRewriteBufferFor(FileID FID) const
+{
+  materialize();
+  return Rewriter::getRewriteBufferFor(FID);
+}
+
+const EditRewriter::EditList *EditRewriter::getEdits(FileID FID) const
+{
+  std::map<FileID, EditList>::const_iterator FI = Edits.find(FID);
+  return FI == Edits.end() ? NULL : &FI->second;
+}
+
+bool EditRewriter::write(FileID FID, llvm::raw_ostream &OS) const
+{
+  if (Materialized) {
+    const RewriteBuffer *RWBuf = Rewriter::getRewriteBufferFor(FID);
+    if (!RWBuf)
+      return false;
+    OS << std::string(RWBuf->begin(), RWBuf->end());
+    return true;
+  }
+
+  const EditList *List = getEdits(FID);
+  if (!List)
+    return false;
+
+  StringRef Buf = getSourceMgr().getBufferData(FID);
+  unsigned Pos = 0;
+  for (EditList::const_iterator I = List->begin(), E = List->end();
+       I != E; ++I) {
+    OS << Buf.substr(Pos, I->first - Pos) << I->second.Text;
+    Pos = I->first + I->second.Length;
+  }
+  OS << Buf.substr(Pos);
+  return true;
+}
+
+void EditRewriter::checkpoint(void)
+{
+  UndoLog.clear();
+  Checkpointed = true;
+}
+
+bool EditRewriter::rollback(void)
+{
+  assert(Checkpointed && "No checkpoint!");
+  Checkpointed = false;
+  if (Materialized)
+    return false;
+
+  for (std::vector<Undo>::reverse_iterator I = UndoLog.rbegin(),
+       E = UndoLog.rend(); I != E; ++I) {
+    EditList &List = Edits[I->FID];
+    if (I->IsNew)
+      List.erase(I->Offset);
+    else
+      List[I->Offset].Text = I->Text;
+    if (List.empty())
+      Edits.erase(I->FID);
+  }
+  UndoLog.clear();
+  return true;
+}
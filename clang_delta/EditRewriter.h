@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012, 2013, 2014, 2015, 2016, 2018, 2019 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef EDIT_REWRITER_H
+#define EDIT_REWRITER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Rewrite/Core/Rewriter.h"
+
+namespace llvm {
+  class raw_ostream;
+}
+
+// A drop-in replacement for clang::Rewriter which keeps the edits of each
+// file as a list of ordered, non-overlapping records instead of applying
+// them to a RewriteRope one by one. The records are spliced into the
+// original buffer in a single linear pass when the file is written.
+//
+// An edit which conflicts with a recorded one (it overlaps the range of a
+// removal or a replacement, or it touches an inserted text) has
+// order-dependent semantics in clang::Rewriter. In that case all the
+// records are replayed into the underlying clang::Rewriter, and every later
+// edit is applied to it directly, so the result is always the one
+// clang::Rewriter would produce. The same happens when the rewritten text
+// of an edited range is queried.
+//
+// The edit methods hide the ones of clang::Rewriter, so all the edits must
+// go through an EditRewriter (not a clang::Rewriter pointer or reference).
+class EditRewriter : public clang::Rewriter {
+public:
+  struct Edit {
+    // Offset and length of the replaced text in the original buffer.
+    // An insertion has zero length; all the texts inserted at an offset
+    // are merged into one record.
+    unsigned Offset;
+
+    unsigned Length;
+
+    std::string Text;
+
+    bool IsInsertion;
+  };
+
+  // Records of a file, keyed by their offsets
+  typedef std::map<unsigned, Edit> EditList;
+
+  EditRewriter(void)
+    : Materialized(false),
+      Checkpointed(false)
+  { }
+
+  bool InsertText(clang::SourceLocation Loc, llvm::StringRef Str,
+                  bool InsertAfter = true, bool indentNewLines = false);
+
+  bool InsertTextAfter(clang::SourceLocation Loc, llvm::StringRef Str) {
+    return InsertText(Loc, Str);
+  }
+
+  bool InsertTextBefore(clang::SourceLocation Loc, llvm::StringRef Str) {
+    return InsertText(Loc, Str, false);
+  }
+
+  bool InsertTextAfterToken(clang::SourceLocation Loc, llvm::StringRef Str);
+
+  bool RemoveText(clang::SourceLocation Start, unsigned Length,
+                  RewriteOptions opts = RewriteOptions());
+
+  bool RemoveText(clang::CharSourceRange range,
+                  RewriteOptions opts = RewriteOptions());
+
+  bool RemoveText(clang::SourceRange range,
+                  RewriteOptions opts = RewriteOptions()) {
+    return RemoveText(clang::CharSourceRange::getTokenRange(range), opts);
+  }
+
+  bool ReplaceText(clang::SourceLocation Start, unsigned OrigLength,
+                   llvm::StringRef NewStr);
+
+  bool ReplaceText(clang::CharSourceRange range, llvm::StringRef NewStr);
+
+  bool ReplaceText(clang::SourceRange range, llvm::StringRef NewStr) {
+    return ReplaceText(clang::CharSourceRange::getTokenRange(range), NewStr);
+  }
+
+  bool ReplaceText(clang::SourceRange range,
+                   clang::SourceRange replacementRange);
+
+  int getRangeSize(const clang::CharSourceRange &Range,
+                   RewriteOptions opts = RewriteOptions()) const;
+
+  int getRangeSize(clang::SourceRange Range,
+                   RewriteOptions opts = RewriteOptions()) const {
+    return getRangeSize(clang::CharSourceRange::getTokenRange(Range), opts);
+  }
+
+  std::string getRewrittenText(clang::SourceRange Range) const;
+
+  const clang::RewriteBuffer *getRewriteBufferFor(clang::FileID FID) const;
+
+  // Return the pending records of FID, or NULL if there are none because
+  // the file is unchanged or the records have been replayed.
+  const EditList *getEdits(clang::FileID FID) const;
+
+  // Write the rewritten FID to OS. Return false if FID is unchanged.
+  bool write(clang::FileID FID, llvm::raw_ostream &OS) const;
+
+  // Start keeping track of the edits, so that they can be discarded
+  void checkpoint(void);
+
+  // Discard the edits made since the checkpoint. Return false if that
+  // can't be done because the records have been replayed.
+  bool rollback(void);
+
+  // Keep the edits made since the checkpoint
+  void commit(void) {
+    UndoLog.clear();
+    Checkpointed = false;
+  }
+
+private:
+  bool getRangeOffsets(clang::CharSourceRange Range, clang::FileID &FID,
+                       unsigned &Start, unsigned &End) const;
+
+  bool conflicts(clang::FileID FID, const Edit &E) const;
+
+  bool overlapsEdits(const clang::CharSourceRange &Range) const;
+
+  bool addEdit(clang::FileID FID, const Edit &E, bool InsertAfter);
+
+  void materialize(void) const;
+
+  mutable std::map<clang::FileID, EditList> Edits;
+
+  // Set once the records have been replayed into clang::Rewriter
+  mutable bool Materialized;
+
+  // The records changed since the checkpoint, with their previous texts
+  // (none for the new ones)
+  struct Undo {
+    clang::FileID FID;
+
+    unsigned Offset;
+
+    bool IsNew;
+
+    std::string Text;
+  };
+
+  std::vector<Undo> UndoLog;
+
+  bool Checkpointed;
+};
+
+#endif
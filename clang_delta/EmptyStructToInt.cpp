@@ -77,6 +77,7 @@ private:
 bool EmptyStructToIntASTVisitor::VisitRecordDecl(RecordDecl *RD)
 {
   if (ConsumerInstance->isInIncludedFile(RD) ||
+      ConsumerInstance->isOutsideRegions(RD) ||
       !ConsumerInstance->isValidRecordDecl(RD))
     return true;
  
@@ -250,6 +250,7 @@ bool ExprDetectorCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
   }
 
   if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD) ||
       !FD->isThisDeclarationADefinition())
     return true;
 
@@ -267,7 +268,8 @@ bool ExprDetectorCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 
 bool ExprDetectorStmtVisitor::VisitExpr(Expr *E)
 {
-  if (ConsumerInstance->isInIncludedFile(E))
+  if (ConsumerInstance->isInIncludedFile(E) ||
+      ConsumerInstance->isOutsideRegions(E))
     return true;
 
   switch(E->getStmtClass()) {
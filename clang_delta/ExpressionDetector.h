@@ -47,6 +47,10 @@ public:
 
   ~ExpressionDetector(void);
 
+  virtual bool usesPreprocessorCallbacks() {
+    return true;
+  }
+
 private:
   struct HeaderFunctionInfo {
     HeaderFunctionInfo () : HasHeader(false), HasFunction(false) { }
@@ -0,0 +1,28 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "RemoveNamespace.h"
+
+#include "TransformationManager.h"
+
+static const char *DescriptionMsg =
+"Remove all the namespaces at once. The names declared by more than \
+one namespace, or also visible in the global scope, are prefixed with \
+the name of their namespace, so that no name conflicts are introduced. \n";
+
+static RegisterTransformation<RemoveNamespace, RemoveNamespace::EMode>
+         Trans("flatten-namespaces", DescriptionMsg,
+               RemoveNamespace::EMode::Flatten);
+
+// Implementation is in RemoveNamespace.cpp
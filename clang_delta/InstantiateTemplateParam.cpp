@@ -345,7 +345,7 @@ InstantiateTemplateParam::getTemplateArgumentString(const TemplateArgument &Arg,
 void InstantiateTemplateParam::handleOneTemplateSpecialization(
        const TemplateDecl *D, const TemplateArgumentList & ArgList, const clang::Decl* Spec)
 {
-  if (isInIncludedFile(D))
+  if (isInIncludedFile(D) || isOutsideRegions(D))
     return;
 
   NamedDecl *TD = D->getTemplatedDecl();
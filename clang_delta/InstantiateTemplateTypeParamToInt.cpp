@@ -232,7 +232,7 @@ void InstantiateTemplateTypeParamToInt::HandleTranslationUnit(ASTContext &Ctx)
 
 void InstantiateTemplateTypeParamToInt::handleOneTemplateDecl(const TemplateDecl *D)
 {
-  if (isInIncludedFile(D))
+  if (isInIncludedFile(D) || isOutsideRegions(D))
     return;
 
   // doesn't handle TypeAliasTemplateDecl
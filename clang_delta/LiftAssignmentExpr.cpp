@@ -77,7 +77,8 @@ private:
 bool AssignExprCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
   if (!FD->isThisDeclarationADefinition() ||
-      ConsumerInstance->isInIncludedFile(FD))
+      ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD))
     return true;
 
   ConsumerInstance->StmtVisitor->setCurrentFunctionDecl(FD);
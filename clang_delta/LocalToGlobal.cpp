@@ -104,7 +104,8 @@ bool LocalToGlobalCollectionVisitor::VisitVarDecl(VarDecl *VD)
 {
   TransAssert(CurrentFuncDecl && "NULL CurrentFuncDecl!");
 
-  if (ConsumerInstance->isInIncludedFile(VD) || !VD->isLocalVarDecl() ||
+  if (ConsumerInstance->isInIncludedFile(VD) ||
+      ConsumerInstance->isOutsideRegions(VD) || !VD->isLocalVarDecl() ||
       VD->isStaticLocal() || VD->hasExternalStorage() ||
       ConsumerInstance->SkippedVars.count(VD->getCanonicalDecl()))
     return true;
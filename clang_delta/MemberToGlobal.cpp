@@ -189,7 +189,7 @@ bool MemberToGlobal::isValidDecl(clang::RecordDecl* RD, clang::Decl* D) {
   if (isa<FriendDecl>(D))
     return false;
 
-  if (isInIncludedFile(D))
+  if (isInIncludedFile(D) || isOutsideRegions(D))
     return false;
 
   return true;
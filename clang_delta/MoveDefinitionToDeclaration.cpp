@@ -44,7 +44,7 @@ public:
 
     auto DefRange = ConsumerInstance->RewriteHelper->getDeclFullSourceRange(Def);
     auto DeclRange = ConsumerInstance->RewriteHelper->getDeclFullSourceRange(Decl);
-    if (DefRange.isInvalid() || DeclRange.isInvalid() || ConsumerInstance->isInIncludedFile(DefRange) || ConsumerInstance->isInIncludedFile(DeclRange))
+    if (DefRange.isInvalid() || DeclRange.isInvalid() || ConsumerInstance->isInIncludedFile(DefRange) || ConsumerInstance->isOutsideRegions(DefRange) || ConsumerInstance->isInIncludedFile(DeclRange))
       return;
 
     auto Text = ConsumerInstance->TheRewriter.getRewrittenText({ DeclRange.getEnd(), DefRange.getBegin().getLocWithOffset(-1) });
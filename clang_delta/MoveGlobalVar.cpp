@@ -51,7 +51,7 @@ bool MoveGlobalVar::HandleTopLevelDecl(DeclGroupRef D)
   DeclGroupRef::iterator I = D.begin();
   TransAssert((I != D.end()) && "Bad DeclGroupRef!");
 
-  if (isInIncludedFile(*I))
+  if (isInIncludedFile(*I) || isOutsideRegions(*I))
     return true;
 
   const NamedDecl *ND = dyn_cast<NamedDecl>(*I);
@@ -172,7 +172,7 @@ bool ParamToGlobal::isValidFuncDecl(FunctionDecl *FD)
 
   TransAssert(isa<FunctionDecl>(FD) && "Must be a FunctionDecl");
 
-  if (isInIncludedFile(FD))
+  if (isInIncludedFile(FD) || isOutsideRegions(FD))
     return false;
 
   // Skip the case like foo(int, ...), because we cannot remove
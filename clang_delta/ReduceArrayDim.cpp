@@ -139,7 +139,7 @@ void ReduceArrayDim::HandleTranslationUnit(ASTContext &Ctx)
 
 void ReduceArrayDim::addOneVar(const VarDecl *VD)
 {
-  if (isInIncludedFile(VD))
+  if (isInIncludedFile(VD) || isOutsideRegions(VD))
     return;
 
   const Type *Ty = VD->getType().getTypePtr();
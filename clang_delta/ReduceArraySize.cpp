@@ -182,7 +182,7 @@ void ReduceArraySize::rewriteArrayVarDecl(void)
 
 void ReduceArraySize::handleOneVar(const VarDecl *VD)
 {
-  if (isInIncludedFile(VD))
+  if (isInIncludedFile(VD) || isOutsideRegions(VD))
     return;
 
   const Type *Ty = VD->getType().getTypePtr();
@@ -218,7 +218,8 @@ bool ReduceClassTemplateParameterRewriteVisitor::
 bool ReduceClassTemplateParameterASTVisitor::VisitClassTemplateDecl(
        ClassTemplateDecl *D)
 {
-  if (ConsumerInstance->isInIncludedFile(D))
+  if (ConsumerInstance->isInIncludedFile(D) ||
+      ConsumerInstance->isOutsideRegions(D))
     return true;
 
   ClassTemplateDecl *CanonicalD = D->getCanonicalDecl();
@@ -117,7 +117,8 @@ bool PointerLevelCollectionVisitor::isVAArgField(DeclaratorDecl *DD)
 // I skipped IndirectFieldDecl for now
 bool PointerLevelCollectionVisitor::VisitDeclaratorDecl(DeclaratorDecl *DD)
 {
-  if (ConsumerInstance->isInIncludedFile(DD) || isVAArgField(DD))
+  if (ConsumerInstance->isInIncludedFile(DD) ||
+      ConsumerInstance->isOutsideRegions(DD) || isVAArgField(DD))
     return true;
 
   // Only consider FieldDecl and VarDecl
@@ -489,8 +490,10 @@ void ReducePointerLevel::doAnalysis(void)
 
   Decls = AllPtrDecls[MaxIndirectLevel];
   if (Decls) {
-    for (DeclSet::const_iterator I = Decls->begin(), E = Decls->end();
-         I != E; ++I) {
+    DeclVector SortedDecls(Decls->begin(), Decls->end());
+    sortBySourceOrder(SortedDecls);
+    for (DeclVector::const_iterator I = SortedDecls.begin(),
+         E = SortedDecls.end(); I != E; ++I) {
       if (!ValidDecls.count(*I))
         continue;
       ValidInstanceNum++;
@@ -504,8 +507,10 @@ void ReducePointerLevel::doAnalysis(void)
     if (!Decls)
       continue;
 
-    for (DeclSet::const_iterator I = Decls->begin(), E = Decls->end();
-         I != E; ++I) {
+    DeclVector SortedDecls(Decls->begin(), Decls->end());
+    sortBySourceOrder(SortedDecls);
+    for (DeclVector::const_iterator I = SortedDecls.begin(),
+         E = SortedDecls.end(); I != E; ++I) {
       if (!ValidDecls.count(*I) || AddrTakenDecls.count(*I))
         continue;
       ValidInstanceNum++;
@@ -58,6 +58,8 @@ private:
   
   typedef llvm::SmallPtrSet<const clang::DeclaratorDecl *, 20> DeclSet;
 
+  typedef llvm::SmallVector<const clang::DeclaratorDecl *, 20> DeclVector;
+
   typedef llvm::SmallPtrSet<const clang::DeclRefExpr *, 20> DeclRefExprSet;
 
   typedef llvm::SmallPtrSet<const clang::MemberExpr *, 20> MemberExprSet;
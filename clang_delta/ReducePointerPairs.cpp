@@ -263,16 +263,20 @@ void ReducePointerPairs::HandleTranslationUnit(ASTContext &Ctx)
 
 void ReducePointerPairs::doAnalysis(void)
 {
+  VarDeclVector VarDecls;
   for (PointerMap::iterator I = ValidPointerPairs.begin(),
        E = ValidPointerPairs.end(); I != E; ++I) {
-    const VarDecl *PairedVD = (*I).second;
-    if (!PairedVD)
-      continue;
+    if ((*I).second)
+      VarDecls.push_back((*I).first);
+  }
+  sortBySourceOrder(VarDecls);
 
+  for (VarDeclVector::iterator I = VarDecls.begin(),
+       E = VarDecls.end(); I != E; ++I) {
     ValidInstanceNum++;
     if (TransformationCounter == ValidInstanceNum) {
-      TheVarDecl = (*I).first;
-      ThePairedVarDecl = PairedVD;
+      TheVarDecl = (*I);
+      ThePairedVarDecl = ValidPointerPairs[*I];
     }
   }
 }
@@ -288,7 +292,7 @@ void ReducePointerPairs::doRewriting(const VarDecl *VD)
 
 bool ReducePointerPairs::isValidVD(const VarDecl *VD)
 {
-  if (isInIncludedFile(VD) || dyn_cast<ParmVarDecl>(VD))
+  if (isInIncludedFile(VD) || isOutsideRegions(VD) || dyn_cast<ParmVarDecl>(VD))
     return false;
 
   const Type *Ty = VD->getType().getTypePtr();
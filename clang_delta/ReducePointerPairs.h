@@ -44,6 +44,8 @@ private:
   typedef llvm::DenseMap<const clang::VarDecl *, const clang::VarDecl *> 
             PointerMap;
 
+  typedef llvm::SmallVector<const clang::VarDecl *, 20> VarDeclVector;
+
   virtual void Initialize(clang::ASTContext &context);
 
   virtual void HandleTranslationUnit(clang::ASTContext &Ctx);
@@ -63,6 +63,7 @@ void RemoveAddrTakenCollectionVisitor::handleOneAddrTakenOp(
        const UnaryOperator *UO)
 {
   if (ConsumerInstance->isInIncludedFile(UO) ||
+      ConsumerInstance->isOutsideRegions(UO) ||
       ConsumerInstance->VisitedAddrTakenOps.count(UO))
     return;
 
@@ -266,7 +266,7 @@ void RemoveArray::addOneArraySubscriptExpr(ArraySubscriptExpr *ASE,
 
 void RemoveArray::handleOneVarDecl(const VarDecl *VD)
 {
-  if (isInIncludedFile(VD) || VD->getAnyInitializer())
+  if (isInIncludedFile(VD) || isOutsideRegions(VD) || VD->getAnyInitializer())
     return;
 
   const Type *Ty = VD->getType().getTypePtr();
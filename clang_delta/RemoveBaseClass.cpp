@@ -48,6 +48,34 @@ private:
   RemoveBaseClass *ConsumerInstance;
 };
 
+class CollapseHierarchyRewriteVisitor : public
+  CommonRenameClassRewriteVisitor<CollapseHierarchyRewriteVisitor>
+{
+public:
+  CollapseHierarchyRewriteVisitor(Transformation *Instance,
+                                  EditRewriter *RT,
+                                  RewriteUtils *Helper,
+                                  const CXXRecordDecl *CXXRD,
+                                  const std::string &Name)
+    : CommonRenameClassRewriteVisitor<CollapseHierarchyRewriteVisitor>
+      (Instance, RT, Helper, CXXRD, Name)
+  { }
+};
+
+static const char *getAccessSpecifierStr(AccessSpecifier AS)
+{
+  switch (AS) {
+  case AS_public:
+    return "public";
+  case AS_protected:
+    return "protected";
+  case AS_private:
+    return "private";
+  default:
+    return "";
+  }
+}
+
 bool RemoveBaseClassBaseVisitor::VisitCXXRecordDecl(
        CXXRecordDecl *CXXRD)
 {
@@ -111,6 +139,11 @@ void RemoveBaseClass::handleOneCXXRecordDecl(const CXXRecordDecl *CXXRD)
   if (isSpecialRecordDecl(CXXRD) || !CXXRD->isThisDeclarationADefinition())
     return;
 
+  if (Mode == EMode::Collapse) {
+    handleOneCollapsedRecordDecl(CXXRD);
+    return;
+  }
+
   for (const CXXBaseSpecifier& BS : CXXRD->bases()) {
     auto* Base = BS.getType()->getAsCXXRecordDecl();
 
@@ -118,7 +151,7 @@ void RemoveBaseClass::handleOneCXXRecordDecl(const CXXRecordDecl *CXXRD)
       continue;
     if (Mode == EMode::Merge && getNumExplicitDecls(Base) > MaxNumDecls)
       continue;
-    if (isInIncludedFile(Base))
+    if (isInIncludedFile(Base) || isOutsideRegions(Base))
       continue;
 
     ValidInstanceNum++;
@@ -132,6 +165,11 @@ void RemoveBaseClass::handleOneCXXRecordDecl(const CXXRecordDecl *CXXRD)
 
 void RemoveBaseClass::doRewrite(void)
 {
+  if (Mode == EMode::Collapse) {
+    collapseHierarchy();
+    return;
+  }
+
   if (Mode == EMode::Merge)
     copyBaseClassDecls();
   removeBaseSpecifier();
@@ -209,7 +247,8 @@ void RemoveBaseClass::removeBaseSpecifier(void)
 {
   unsigned NumBases = TheDerivedClass->getNumBases();
   TransAssert((NumBases >= 1) && "TheDerivedClass doesn't have any base!");
-  if (NumBases == 1) {
+  // all the bases go away when the hierarchy is collapsed
+  if (NumBases == 1 || Mode == EMode::Collapse) {
     SourceLocation StartLoc = TheDerivedClass->getLocation();
     StartLoc = RewriteHelper->getLocationUntil(StartLoc, ':');
     SourceLocation EndLoc = RewriteHelper->getLocationUntil(StartLoc, '{');
@@ -277,6 +316,348 @@ void RemoveBaseClass::removeBaseInitializer(void)
   }
 }
 
+bool RemoveBaseClass::isCollapsibleClass(const CXXRecordDecl *CXXRD)
+{
+  return !isInIncludedFile(CXXRD) && !isOutsideRegions(CXXRD) &&
+         !isa<ClassTemplateSpecializationDecl>(CXXRD) &&
+         !CXXRD->getDescribedClassTemplate() &&
+         !CXXRD->isDependentContext() &&
+         !CXXRD->isUnion();
+}
+
+// An ancestor is replaced with a declaration of Derived, so it must live
+// in the same scope, must not declare anything else, and its members
+// defined out of line must come after Derived's definition.
+bool RemoveBaseClass::isCollapsibleAncestor(const CXXRecordDecl *Base,
+                                            const CXXRecordDecl *Derived)
+{
+  if (!isCollapsibleClass(Base) || isDeclaringRecordDecl(Base))
+    return false;
+  if (Base->getDeclContext()->getRedeclContext() !=
+      Derived->getDeclContext()->getRedeclContext())
+    return false;
+
+  for (const Decl *Member : Base->decls()) {
+    for (const Decl *Redecl : Member->redecls()) {
+      if (Redecl->getLexicalDeclContext() != Base &&
+          isBeforeInSource(Redecl, Derived))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool RemoveBaseClass::collectAncestors(const CXXRecordDecl *CXXRD,
+                                       const CXXRecordDecl *Derived,
+                                       CXXRecordDeclVector &Ancestors,
+                                       CXXRecordDeclSet &Visited)
+{
+  for (const CXXBaseSpecifier &BS : CXXRD->bases()) {
+    const CXXRecordDecl *Base = BS.getType()->getAsCXXRecordDecl();
+    if (!Base || !Base->hasDefinition())
+      return false;
+    Base = Base->getDefinition();
+    // a shared base of a DAG is collapsed once
+    if (!Visited.insert(Base->getCanonicalDecl()).second)
+      continue;
+    if (!isCollapsibleAncestor(Base, Derived) ||
+        !collectAncestors(Base, Derived, Ancestors, Visited))
+      return false;
+    Ancestors.push_back(Base);
+  }
+  return true;
+}
+
+void RemoveBaseClass::handleOneCollapsedRecordDecl(const CXXRecordDecl *CXXRD)
+{
+  if (!CXXRD->getNumBases() || !isCollapsibleClass(CXXRD))
+    return;
+
+  CXXRecordDeclVector Ancestors;
+  CXXRecordDeclSet Visited;
+  if (!collectAncestors(CXXRD, CXXRD, Ancestors, Visited))
+    return;
+
+  ValidInstanceNum++;
+  if (ValidInstanceNum == TransformationCounter) {
+    TheBaseClass = Ancestors.back();
+    TheDerivedClass = CXXRD;
+    CollapsedAncestors = Ancestors;
+    CollapsedAncestorSet = Visited;
+  }
+}
+
+bool RemoveBaseClass::isCollapsedClass(const CXXRecordDecl *CXXRD)
+{
+  const CXXRecordDecl *CanonicalRD = CXXRD->getCanonicalDecl();
+  return CanonicalRD == TheDerivedClass->getCanonicalDecl() ||
+         CollapsedAncestorSet.count(CanonicalRD);
+}
+
+// All the classes of the hierarchy are spelled as the derived class after
+// the collapse, so they compare equal here
+bool RemoveBaseClass::isSameCollapsedType(QualType T1, QualType T2)
+{
+  T1 = Context->getCanonicalType(T1);
+  T2 = Context->getCanonicalType(T2);
+  if (T1.getCVRQualifiers() != T2.getCVRQualifiers())
+    return false;
+
+  const Type *Ty1 = T1.getTypePtr();
+  const Type *Ty2 = T2.getTypePtr();
+  if (Ty1->getTypeClass() != Ty2->getTypeClass())
+    return false;
+  if (const PointerType *PT = dyn_cast<PointerType>(Ty1))
+    return isSameCollapsedType(PT->getPointeeType(),
+                               cast<PointerType>(Ty2)->getPointeeType());
+  if (const ReferenceType *RT = dyn_cast<ReferenceType>(Ty1))
+    return isSameCollapsedType(RT->getPointeeType(),
+                               cast<ReferenceType>(Ty2)->getPointeeType());
+
+  const CXXRecordDecl *RD1 = Ty1->getAsCXXRecordDecl();
+  const CXXRecordDecl *RD2 = Ty2->getAsCXXRecordDecl();
+  if (RD1 && RD2 && isCollapsedClass(RD1) && isCollapsedClass(RD2))
+    return true;
+  return Context->hasSameType(T1, T2);
+}
+
+bool RemoveBaseClass::haveSameCollapsedSignature(const FunctionDecl *FD1,
+                                                 const FunctionDecl *FD2)
+{
+  if (FD1->getNumParams() != FD2->getNumParams())
+    return false;
+  for (unsigned I = 0; I < FD1->getNumParams(); ++I) {
+    if (!isSameCollapsedType(FD1->getParamDecl(I)->getType(),
+                             FD2->getParamDecl(I)->getType()))
+      return false;
+  }
+
+  const CXXMethodDecl *MD1 = dyn_cast<CXXMethodDecl>(FD1);
+  const CXXMethodDecl *MD2 = dyn_cast<CXXMethodDecl>(FD2);
+  if (MD1 && MD2)
+    return MD1->isConst() == MD2->isConst() &&
+           MD1->isVolatile() == MD2->isVolatile();
+  return true;
+}
+
+bool RemoveBaseClass::getMemberKey(const Decl *D, std::string &Key)
+{
+  const NamedDecl *ND = dyn_cast<NamedDecl>(D);
+  if (!ND)
+    return false;
+  if (const FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(ND))
+    ND = FTD->getTemplatedDecl();
+
+  switch (ND->getDeclName().getNameKind()) {
+  case DeclarationName::CXXConstructorName:
+    Key = "<ctor>";
+    return true;
+  case DeclarationName::CXXDestructorName:
+    Key = "<dtor>";
+    return true;
+  default:
+    break;
+  }
+
+  if (ND->getDeclName().isEmpty())
+    return false;
+  Key = ND->getNameAsString();
+  return true;
+}
+
+void RemoveBaseClass::addMembers(const CXXRecordDecl *CXXRD,
+                                 MemberKeyMap &Members)
+{
+  for (const Decl *D : CXXRD->decls()) {
+    if (D->isImplicit())
+      continue;
+    std::string Key;
+    if (getMemberKey(D, Key))
+      Members[Key].push_back(D);
+
+    // enumerators of an unscoped enum are members of the class as well
+    const EnumDecl *ED = dyn_cast<EnumDecl>(D);
+    if (!ED || ED->isScoped())
+      continue;
+    for (const EnumConstantDecl *ECD : ED->enumerators())
+      Members[ECD->getNameAsString()].push_back(ECD);
+  }
+}
+
+// A member of an ancestor is dropped if a nearer class already has a member
+// with its name, or a function with its signature (including the ones
+// overriding it). Any destructor of a nearer class hides the ancestor's.
+bool RemoveBaseClass::isHiddenMember(const Decl *D,
+                                     const MemberKeyMap &Members)
+{
+  std::string Key;
+  if (!getMemberKey(D, Key))
+    return false;
+  MemberKeyMap::const_iterator Pos = Members.find(Key);
+  if (Pos == Members.end())
+    return false;
+
+  const FunctionDecl *FD = dyn_cast<FunctionDecl>(D);
+  if (!FD || isa<CXXDestructorDecl>(FD))
+    return true;
+  for (const Decl *Other : Pos->second) {
+    const FunctionDecl *OtherFD = dyn_cast<FunctionDecl>(Other);
+    if (!OtherFD || haveSameCollapsedSignature(FD, OtherFD))
+      return true;
+  }
+  return false;
+}
+
+// Remove the initializers of the collapsed bases from the definition of D
+// if it is a constructor
+void RemoveBaseClass::removeCollapsedBaseInitializers(const Decl *D)
+{
+  if (const FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(D))
+    D = FTD->getTemplatedDecl();
+  const CXXConstructorDecl *Ctor = dyn_cast<CXXConstructorDecl>(D);
+  const FunctionDecl *Def = NULL;
+  if (!Ctor || Ctor->isImplicit() || !Ctor->hasBody(Def) ||
+      Def->isDefaulted())
+    return;
+  Ctor = cast<CXXConstructorDecl>(Def);
+
+  llvm::SmallVector<const CXXCtorInitializer *, 8> Inits;
+  llvm::SmallVector<bool, 8> IsRemoved;
+  unsigned NumRemoved = 0;
+  for (const CXXCtorInitializer *Init : Ctor->inits()) {
+    if (!Init->isWritten())
+      continue;
+    const CXXRecordDecl *Base = NULL;
+    if (Init->isBaseInitializer())
+      Base = Init->getBaseClass()->getAsCXXRecordDecl();
+    bool Removed = Base && CollapsedAncestorSet.count(Base->getCanonicalDecl());
+    Inits.push_back(Init);
+    IsRemoved.push_back(Removed);
+    NumRemoved += Removed;
+  }
+  if (!NumRemoved)
+    return;
+
+  if (NumRemoved == Inits.size()) {
+    RewriteHelper->removeTextFromLeftAt(Inits.front()->getSourceRange(), ':',
+                                        Inits.back()->getRParenLoc());
+    return;
+  }
+
+  // Initializers before the first kept one take their trailing commas,
+  // the others their leading ones
+  bool HasKeptInit = false;
+  for (unsigned I = 0; I < Inits.size(); ++I) {
+    if (!IsRemoved[I]) {
+      HasKeptInit = true;
+      continue;
+    }
+    SourceRange Range = Inits[I]->getSourceRange();
+    if (HasKeptInit)
+      RewriteHelper->removeTextFromLeftAt(Range, ',',
+                                          Inits[I]->getRParenLoc());
+    else
+      RewriteHelper->removeTextUntil(Range, ',');
+  }
+}
+
+// Copy the members of the ancestors, the root classes first, to the
+// beginning of the derived class. The access of every member is kept.
+void RemoveBaseClass::copyCollapsedMembers(const DeclSet &HiddenDecls)
+{
+  AccessSpecifier DefaultAS = TheDerivedClass->isClass() ? AS_private
+                                                         : AS_public;
+  AccessSpecifier LastAS = DefaultAS;
+  SourceLocation LastLoc;
+  std::string MembersStr;
+  for (const CXXRecordDecl *Base : CollapsedAncestors) {
+    for (const Decl *D : Base->decls()) {
+      if (D->isImplicit() || isa<AccessSpecDecl>(D) || HiddenDecls.count(D))
+        continue;
+
+      SourceRange Range = RewriteHelper->getDeclFullSourceRange(D);
+      // the declarators of a group share the same text, e.g., int a, b;
+      if (Range.getBegin() == LastLoc)
+        continue;
+      LastLoc = Range.getBegin();
+
+      AccessSpecifier AS = D->getAccess();
+      if (AS != AS_none && AS != LastAS) {
+        MembersStr += std::string(getAccessSpecifierStr(AS)) + ":\n";
+        LastAS = AS;
+      }
+      MembersStr += TheRewriter.getRewrittenText(Range) + "\n";
+    }
+  }
+  if (MembersStr.empty())
+    return;
+
+  if (LastAS != DefaultAS)
+    MembersStr += std::string(getAccessSpecifierStr(DefaultAS)) + ":\n";
+  SourceLocation LBraceLoc = TheDerivedClass->getBraceRange().getBegin();
+  TheRewriter.InsertTextAfter(LBraceLoc.getLocWithOffset(1),
+                              "\n" + MembersStr);
+}
+
+void RemoveBaseClass::collapseHierarchy(void)
+{
+  // Walk from the derived class to the roots, so that the member
+  // nearest to the derived class wins
+  MemberKeyMap Members;
+  DeclSet HiddenDecls;
+  addMembers(TheDerivedClass, Members);
+  for (CXXRecordDeclVector::reverse_iterator I = CollapsedAncestors.rbegin(),
+       E = CollapsedAncestors.rend(); I != E; ++I) {
+    for (const Decl *D : (*I)->decls()) {
+      if (!D->isImplicit() && isHiddenMember(D, Members))
+        HiddenDecls.insert(D);
+    }
+    addMembers(*I, Members);
+  }
+
+  // Every reference to an ancestor, including qualified names and casts,
+  // now names the derived class
+  const std::string NameStr = TheDerivedClass->getNameAsString();
+  CollapseHierarchyRewriteVisitor RewriteVisitor(
+    this, &TheRewriter, RewriteHelper,
+    CollapsedAncestors.front()->getCanonicalDecl(), NameStr);
+  for (const CXXRecordDecl *Base : CollapsedAncestors)
+    RewriteVisitor.addCXXRecordDecl(Base);
+  RewriteVisitor.TraverseDecl(Context->getTranslationUnitDecl());
+
+  for (const Decl *D : TheDerivedClass->decls())
+    removeCollapsedBaseInitializers(D);
+  for (const CXXRecordDecl *Base : CollapsedAncestors) {
+    for (const Decl *D : Base->decls()) {
+      if (!HiddenDecls.count(D))
+        removeCollapsedBaseInitializers(D);
+    }
+  }
+
+  copyCollapsedMembers(HiddenDecls);
+
+  for (const Decl *D : HiddenDecls) {
+    for (const Decl *Redecl : D->redecls()) {
+      if (Redecl->getLexicalDeclContext() != D->getDeclContext())
+        TheRewriter.RemoveText(RewriteHelper->getDeclFullSourceRange(Redecl));
+    }
+  }
+
+  // Leave a declaration of the derived class in place of each ancestor,
+  // so that the references preceding its definition still work
+  std::string DeclStr =
+    TheDerivedClass->getKindName().str() + " " + NameStr + ";";
+  for (const CXXRecordDecl *Base : CollapsedAncestors) {
+    for (const CXXRecordDecl *Redecl : Base->redecls()) {
+      SourceRange Range = RewriteHelper->getDeclFullSourceRange(Redecl);
+      if (Range.isValid())
+        TheRewriter.ReplaceText(Range, DeclStr);
+    }
+  }
+
+  removeBaseSpecifier();
+}
+
 RemoveBaseClass::~RemoveBaseClass(void)
 {
   delete CollectionVisitor;
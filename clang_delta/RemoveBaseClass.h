@@ -11,7 +11,10 @@
 #ifndef REMOVE_BASE_CLASS_H
 #define REMOVE_BASE_CLASS_H
 
+#include <map>
+#include <string>
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "Transformation.h"
 
 namespace clang {
@@ -19,6 +22,7 @@ namespace clang {
   class ASTContext;
   class CXXBaseSpecifier;
   class CXXConstructorDecl;
+  class FunctionDecl;
 }
 
 class RemoveBaseClassBaseVisitor;
@@ -27,7 +31,7 @@ class RemoveBaseClass : public Transformation {
 friend class RemoveBaseClassBaseVisitor;
 
 public:
-  enum class EMode { Remove, Merge };
+  enum class EMode { Remove, Merge, Collapse };
 
   RemoveBaseClass(const char *TransName, const char *Desc, EMode Mode)
     : Transformation(TransName, Desc),
@@ -38,6 +42,16 @@ public:
 private:
   typedef llvm::SmallPtrSet<const clang::CXXRecordDecl *, 20> CXXRecordDeclSet;
 
+  typedef llvm::SmallVector<const clang::CXXRecordDecl *, 8>
+    CXXRecordDeclVector;
+
+  typedef llvm::SmallPtrSet<const clang::Decl *, 16> DeclSet;
+
+  // Members of the classes nearer to the most derived one, keyed by
+  // their names ("<ctor>" and "<dtor>" for constructors and destructors)
+  typedef std::map<std::string, llvm::SmallVector<const clang::Decl *, 4> >
+    MemberKeyMap;
+
   virtual void Initialize(clang::ASTContext &context);
 
   virtual void HandleTranslationUnit(clang::ASTContext &Ctx);
@@ -59,12 +73,49 @@ private:
 
   bool isTheBaseClass(const clang::CXXBaseSpecifier &Specifier);
 
+  void handleOneCollapsedRecordDecl(const clang::CXXRecordDecl *CXXRD);
+
+  bool isCollapsibleClass(const clang::CXXRecordDecl *CXXRD);
+
+  bool isCollapsibleAncestor(const clang::CXXRecordDecl *Base,
+                             const clang::CXXRecordDecl *Derived);
+
+  bool collectAncestors(const clang::CXXRecordDecl *CXXRD,
+                        const clang::CXXRecordDecl *Derived,
+                        CXXRecordDeclVector &Ancestors,
+                        CXXRecordDeclSet &Visited);
+
+  bool isCollapsedClass(const clang::CXXRecordDecl *CXXRD);
+
+  bool isSameCollapsedType(clang::QualType T1, clang::QualType T2);
+
+  bool haveSameCollapsedSignature(const clang::FunctionDecl *FD1,
+                                  const clang::FunctionDecl *FD2);
+
+  bool getMemberKey(const clang::Decl *D, std::string &Key);
+
+  void addMembers(const clang::CXXRecordDecl *CXXRD, MemberKeyMap &Members);
+
+  bool isHiddenMember(const clang::Decl *D, const MemberKeyMap &Members);
+
+  void removeCollapsedBaseInitializers(const clang::Decl *D);
+
+  void copyCollapsedMembers(const DeclSet &HiddenDecls);
+
+  void collapseHierarchy(void);
+
   RemoveBaseClassBaseVisitor *CollectionVisitor = nullptr;
 
   const clang::CXXRecordDecl *TheBaseClass = nullptr;
 
   const clang::CXXRecordDecl *TheDerivedClass = nullptr;
 
+  // All the transitive bases of TheDerivedClass, every class after its
+  // own bases (the collapse-class-hierarchy mode)
+  CXXRecordDeclVector CollapsedAncestors;
+
+  CXXRecordDeclSet CollapsedAncestorSet;
+
   const unsigned MaxNumDecls = 5;
 
   EMode Mode;
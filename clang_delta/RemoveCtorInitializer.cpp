@@ -46,7 +46,8 @@ private:
 bool RemoveCtorInitializerASTVisitor::VisitCXXConstructorDecl(
        CXXConstructorDecl *Ctor)
 {
-  if (ConsumerInstance->isInIncludedFile(Ctor))
+  if (ConsumerInstance->isInIncludedFile(Ctor) ||
+      ConsumerInstance->isOutsideRegions(Ctor))
     return true;
 
   unsigned Idx = 0;
@@ -48,7 +48,8 @@ private:
 bool RemoveEnumMemberValueAnalysisVisitor::VisitEnumConstantDecl(
        EnumConstantDecl *ECD)
 {
-  if (ConsumerInstance->isInIncludedFile(ECD) || !ECD->getInitExpr())
+  if (ConsumerInstance->isInIncludedFile(ECD) ||
+      ConsumerInstance->isOutsideRegions(ECD) || !ECD->getInitExpr())
     return true;
 
   ConsumerInstance->ValidInstanceNum++;
@@ -27,8 +27,9 @@ static const char *DescriptionMsg =
 "Remove namespaces. This pass tries to remove namespace without \
 introducing name conflicts. \n";
 
-static RegisterTransformation<RemoveNamespace>
-         Trans("remove-namespace", DescriptionMsg);
+static RegisterTransformation<RemoveNamespace, RemoveNamespace::EMode>
+         Trans("remove-namespace", DescriptionMsg,
+               RemoveNamespace::EMode::Remove);
 
 class RemoveNamespaceASTVisitor : public
   RecursiveASTVisitor<RemoveNamespaceASTVisitor> {
@@ -149,8 +150,7 @@ bool RemoveNamespaceRewriteVisitor::VisitNamespaceDecl(NamespaceDecl *ND)
   if (ConsumerInstance->isForUsingNamedDecls)
     return true;
 
-  const NamespaceDecl *CanonicalND = ND->getCanonicalDecl();
-  if (CanonicalND != ConsumerInstance->TheNamespaceDecl)
+  if (!ConsumerInstance->isRemovedNamespace(ND))
     return true;
 
   ConsumerInstance->removeNamespace(ND);
@@ -171,6 +171,15 @@ bool RemoveNamespaceRewriteVisitor::VisitUsingDirectiveDecl(
   const NamespaceDecl *CanonicalND =
     D->getNominatedNamespace()->getCanonicalDecl();
 
+  // All the namespaces in the qualifier are flattened too
+  if (ConsumerInstance->Mode == RemoveNamespace::EMode::Flatten) {
+    if (ConsumerInstance->isRemovedNamespace(CanonicalND)) {
+      ConsumerInstance->RewriteHelper->removeDecl(D);
+      SkipTraverseNestedNameSpecifier = true;
+    }
+    return true;
+  }
+
   if (CanonicalND == ConsumerInstance->TheNamespaceDecl) {
     // remove the entire Decl if it's in the following form:
     // * using namespace TheNameSpace; or
@@ -223,7 +232,8 @@ bool RemoveNamespaceRewriteVisitor::VisitUsingDecl(UsingDecl *D)
   const NestedNameSpecifier *NNS = D->getQualifier();
   TransAssert(NNS && "Bad NameSpecifier!");
   if (ConsumerInstance->isTheNamespaceSpecifier(NNS) &&
-      (!PrefixLoc || ConsumerInstance->isGlobalNamespace(PrefixLoc))) {
+      (!PrefixLoc || ConsumerInstance->isGlobalNamespace(PrefixLoc) ||
+       ConsumerInstance->Mode == RemoveNamespace::EMode::Flatten)) {
     ConsumerInstance->RewriteHelper->removeDecl(D);
     SkipTraverseNestedNameSpecifier = true;
   }
@@ -239,6 +249,14 @@ bool RemoveNamespaceRewriteVisitor::VisitNamespaceAliasDecl(
 
   const NamespaceDecl *CanonicalND =
     D->getNamespace()->getCanonicalDecl();
+  if (ConsumerInstance->Mode == RemoveNamespace::EMode::Flatten) {
+    if (ConsumerInstance->isRemovedNamespace(CanonicalND)) {
+      ConsumerInstance->RewriteHelper->removeDecl(D);
+      SkipTraverseNestedNameSpecifier = true;
+    }
+    return true;
+  }
+
   if (D->getQualifier()) {
     TraverseNestedNameSpecifierLoc(D->getQualifierLoc());
     if (CanonicalND == ConsumerInstance->TheNamespaceDecl) {
@@ -360,7 +378,7 @@ bool RemoveNamespaceRewriteVisitor::VisitDeclRefExpr(DeclRefExpr *DRE)
           Len = IdInfo->getLength();
         }
       }
-      ConsumerInstance->TheRewriter.ReplaceText(DRE->getBeginLoc(), Len, Name);
+      ConsumerInstance->TheRewriter.ReplaceText(DRE->getLocation(), Len, Name);
     }
   }
 
@@ -582,7 +600,8 @@ bool RemoveNamespaceRewriteVisitor::TraverseNestedNameSpecifierLoc(
       }
       case NestedNameSpecifier::NamespaceAlias: {
         const NamespaceAliasDecl *NAD = NNS->getAsNamespaceAlias();
-        if (!NAD->getQualifier())
+        if (!NAD->getQualifier() ||
+            ConsumerInstance->Mode == RemoveNamespace::EMode::Flatten)
           ND = NAD->getNamespace()->getCanonicalDecl();
         break;
       }
@@ -597,8 +616,10 @@ bool RemoveNamespaceRewriteVisitor::TraverseNestedNameSpecifierLoc(
     if (!ND)
       continue;
 
-    if (ND == ConsumerInstance->TheNamespaceDecl) {
-      ConsumerInstance->RewriteHelper->removeSpecifier(Loc);
+    if (ConsumerInstance->isRemovedNamespace(ND)) {
+      // the specifiers inside the removed namespace are visited twice
+      if (!ConsumerInstance->isForUsingNamedDecls)
+        ConsumerInstance->RewriteHelper->removeSpecifier(Loc);
       continue;
     }
 
@@ -686,7 +707,10 @@ void RemoveNamespace::HandleTranslationUnit(ASTContext &Ctx)
   }
 
   TransAssert(RewriteVisitor && "NULL RewriteVisitor!");
-  TransAssert(TheNamespaceDecl && "NULL TheNamespaceDecl!");
+  if (Mode == EMode::Flatten)
+    planFlattening();
+  else
+    TransAssert(TheNamespaceDecl && "NULL TheNamespaceDecl!");
   Ctx.getDiagnostics().setSuppressAllDiagnostics(false);
 
   // First rename UsingNamedDecls, i.e., conflicting names
@@ -694,7 +718,13 @@ void RemoveNamespace::HandleTranslationUnit(ASTContext &Ctx)
   // FIXME: isForUsingNamedDecls flag is quite ugly,
   //        need a way to remove it
   isForUsingNamedDecls = true;
-  RewriteVisitor->TraverseDecl(TheNamespaceDecl);
+  if (Mode == EMode::Flatten) {
+    for (const NamespaceDecl *ND : TopLevelFlattenedDecls)
+      RewriteVisitor->TraverseDecl(const_cast<NamespaceDecl *>(ND));
+  }
+  else {
+    RewriteVisitor->TraverseDecl(TheNamespaceDecl);
+  }
   isForUsingNamedDecls = false;
 
   rewriteNamedDecls();
@@ -790,7 +820,8 @@ void RemoveNamespace::handleOneUsingShadowDecl(const UsingShadowDecl *UD,
                                                const DeclContext *ParentCtx)
 {
   const NamedDecl *ND = UD->getTargetDecl();
-  if (!hasNameConflict(ND, ParentCtx))
+  // A NULL ParentCtx always means a conflict
+  if (ParentCtx && !hasNameConflict(ND, ParentCtx))
     return;
 
   std::string NewName;
@@ -1006,9 +1037,14 @@ void RemoveNamespace::addNamedDeclsFromNamespace(const NamespaceDecl *ND)
 
 bool RemoveNamespace::handleOneNamespaceDecl(NamespaceDecl *ND)
 {
-  if (isInIncludedFile(ND))
+  if (isInIncludedFile(ND) || isOutsideRegions(ND))
     return true;
 
+  if (Mode == EMode::Flatten) {
+    handleOneFlattenedNamespaceDecl(ND);
+    return true;
+  }
+
   NamespaceDecl *CanonicalND = ND->getCanonicalDecl();
   if (VisitedND.count(CanonicalND)) {
     if (TheNamespaceDecl == CanonicalND) {
@@ -1026,11 +1062,208 @@ bool RemoveNamespace::handleOneNamespaceDecl(NamespaceDecl *ND)
   return true;
 }
 
+// A namespace is flattened if all its decls are in the main file and it is
+// declared in the global scope or in a namespace being flattened. Parents
+// are visited before their children.
+void RemoveNamespace::handleOneFlattenedNamespaceDecl(NamespaceDecl *ND)
+{
+  const NamespaceDecl *CanonicalND = ND->getCanonicalDecl();
+  const DeclContext *ParentCtx = ND->getParent()->getRedeclContext();
+  if (!VisitedND.count(CanonicalND)) {
+    VisitedND.insert(CanonicalND);
+    for (const NamespaceDecl *D : CanonicalND->redecls()) {
+      if (isInIncludedFile(D))
+        return;
+    }
+
+    std::string NamespaceName;
+    if (const NamespaceDecl *Parent = dyn_cast<NamespaceDecl>(ParentCtx)) {
+      NamespaceDeclToNameMap::const_iterator Pos =
+        FlattenedNamespaceNames.find(Parent->getCanonicalDecl());
+      if (Pos == FlattenedNamespaceNames.end())
+        return;
+      NamespaceName = (*Pos).second + "_";
+    }
+    else if (!ParentCtx->isTranslationUnit()) {
+      return;
+    }
+
+    if (ND->isAnonymousNamespace()) {
+      std::stringstream TmpSS;
+      TmpSS << AnonNamePrefix << AnonNamespaceCounter;
+      NamespaceName += TmpSS.str();
+      AnonNamespaceCounter++;
+    }
+    else {
+      NamespaceName += ND->getNameAsString();
+    }
+    FlattenedNamespaceNames[CanonicalND] = NamespaceName;
+    ValidInstanceNum = 1;
+  }
+
+  if (!isRemovedNamespace(ND))
+    return;
+  FlattenedDecls.push_back(ND);
+  if (ParentCtx->isTranslationUnit())
+    TopLevelFlattenedDecls.push_back(ND);
+}
+
+const NamespaceDecl *RemoveNamespace::getFlattenedNamespace(const Decl *D)
+{
+  const DeclContext *Ctx = D->getDeclContext()->getRedeclContext();
+  const NamespaceDecl *ND = dyn_cast<NamespaceDecl>(Ctx);
+  if (ND && isRemovedNamespace(ND))
+    return ND->getCanonicalDecl();
+  return NULL;
+}
+
+void RemoveNamespace::addFlattenedNamedDecl(const NamedDecl *ND,
+                                            const NamespaceDecl *Owner)
+{
+  // Overloaded operators and literal operators keep their names, as they
+  // do in the Remove mode
+  const IdentifierInfo *IdInfo = ND->getIdentifier();
+  if (!IdInfo)
+    return;
+  FlattenedNames[IdInfo->getName().str()][Owner].push_back(ND);
+}
+
+void RemoveNamespace::addFlattenedNamedDecls(const DeclContext *Ctx,
+                                             const NamespaceDecl *Owner)
+{
+  for (DeclContext::decl_iterator I = Ctx->decls_begin(),
+       E = Ctx->decls_end(); I != E; ++I) {
+    // e.g., extern "C" { ... }
+    if (const LinkageSpecDecl *LSD = dyn_cast<LinkageSpecDecl>(*I)) {
+      addFlattenedNamedDecls(LSD, Owner);
+      continue;
+    }
+
+    const NamedDecl *ND = dyn_cast<NamedDecl>(*I);
+    if (!ND)
+      continue;
+
+    if (const UsingShadowDecl *D = dyn_cast<UsingShadowDecl>(ND)) {
+#if LLVM_VERSION_MAJOR < 13
+      const UsingDecl *UD = D->getUsingDecl();
+#else
+      const UsingDecl *UD = dyn_cast<UsingDecl>(D->getIntroducer());
+#endif
+      if (!UD)
+        continue;
+      // The target will be a global decl, or it is qualified with its
+      // namespace everywhere in the flattened namespaces
+      const NamedDecl *Target = D->getTargetDecl();
+      if (Target->getDeclContext()->getRedeclContext()->isTranslationUnit() ||
+          getFlattenedNamespace(Target))
+        UselessUsingDecls.insert(UD);
+      else
+        handleOneUsingShadowDecl(D, NULL);
+      continue;
+    }
+
+    if (const UsingDirectiveDecl *D = dyn_cast<UsingDirectiveDecl>(ND)) {
+      if (!isRemovedNamespace(D->getNominatedNamespace()))
+        handleOneUsingDirectiveDecl(D, NULL);
+      continue;
+    }
+
+    // Nested namespaces being flattened have their own members
+    if (const NamespaceDecl *D = dyn_cast<NamespaceDecl>(ND)) {
+      if (isRemovedNamespace(D))
+        continue;
+    }
+
+    // The references to namespace aliases can't be renamed
+    if (!isValidNamedDeclKind(ND) || isa<NamespaceAliasDecl>(ND))
+      continue;
+
+    addFlattenedNamedDecl(ND, Owner);
+    if (const EnumDecl *ED = dyn_cast<EnumDecl>(ND)) {
+      if (ED->isScoped())
+        continue;
+      for (EnumDecl::enumerator_iterator EI = ED->enumerator_begin(),
+           EE = ED->enumerator_end(); EI != EE; ++EI)
+        addFlattenedNamedDecl(*EI, Owner);
+    }
+  }
+}
+
+// The names visible in the global scope keep their meaning, so any flattened
+// decl with such a name is renamed
+bool RemoveNamespace::hasGlobalNameConflict(const NamedDecl *ND)
+{
+  const TranslationUnitDecl *TUD = Context->getTranslationUnitDecl();
+  DeclContext::lookup_result Result = TUD->lookup(ND->getDeclName());
+  for (DeclContext::lookup_result::iterator I = Result.begin(),
+       E = Result.end(); I != E; ++I) {
+    if (!getFlattenedNamespace(*I))
+      return true;
+  }
+  return false;
+}
+
+std::string RemoveNamespace::getUniqueFlattenedName(const std::string &Name)
+{
+  std::string NewName = Name;
+  for (unsigned Postfix = 1; ; ++Postfix) {
+    if ((Context->Idents.find(NewName) == Context->Idents.end()) &&
+        FlattenedNewNames.insert(NewName).second)
+      return NewName;
+    std::stringstream TmpSS;
+    TmpSS << Name << "_" << Postfix;
+    NewName = TmpSS.str();
+  }
+}
+
+// Resolve the name conflicts of all the flattened namespaces together: a
+// name declared in more than one of them, or also visible in the global
+// scope, is prefixed with the full name of its namespace in each of them.
+// The new names are unique in the translation unit.
+void RemoveNamespace::planFlattening(void)
+{
+  for (const NamespaceDecl *ND : FlattenedDecls)
+    addFlattenedNamedDecls(ND, ND->getCanonicalDecl());
+
+  for (NameToNamespaceDeclsMap::const_iterator I = FlattenedNames.begin(),
+       E = FlattenedNames.end(); I != E; ++I) {
+    const NamespaceDeclToNamedDeclsMap &Owners = (*I).second;
+    if ((Owners.size() == 1) &&
+        !hasGlobalNameConflict(Owners.front().second.front()))
+      continue;
+
+    for (NamespaceDeclToNamedDeclsMap::const_iterator OI = Owners.begin(),
+         OE = Owners.end(); OI != OE; ++OI) {
+      std::string NewName = getUniqueFlattenedName(
+        NamePrefix + FlattenedNamespaceNames[(*OI).first] + "_" + (*I).first);
+      for (const NamedDecl *ND : (*OI).second) {
+        if (const TemplateDecl *TD = dyn_cast<TemplateDecl>(ND))
+          ND = TD->getTemplatedDecl();
+        if (!ND)
+          continue;
+        // including the out-of-line definitions
+        for (const Decl *D : ND->redecls())
+          NamedDeclToNewName[cast<NamedDecl>(D)] = NewName;
+      }
+    }
+  }
+}
+
+// The namespaces of a nested namespace definition, e.g.,
+//   namespace NS1::NS2 { }
+// share the right brace
+bool RemoveNamespace::sharesRBraceWithParent(const NamespaceDecl *ND)
+{
+  const NamespaceDecl *Parent = dyn_cast<NamespaceDecl>(ND->getParent());
+  return Parent && isRemovedNamespace(Parent) &&
+         Parent->getRBraceLoc() == ND->getRBraceLoc();
+}
+
 void RemoveNamespace::removeNamespace(const NamespaceDecl *ND)
 {
   // Remove the right brace first
   SourceLocation RBLoc = ND->getRBraceLoc();
-  if (RBLoc.isValid()) {
+  if (RBLoc.isValid() && !sharesRBraceWithParent(ND)) {
     if (RBLoc.isMacroID()) {
       TheRewriter.RemoveText(SrcManager->getExpansionRange(RBLoc).getAsRange());
     }
@@ -1135,24 +1368,29 @@ bool RemoveNamespace::isGlobalNamespace(NestedNameSpecifierLoc Loc)
   return (NNS->getKind() == NestedNameSpecifier::Global);
 }
 
+bool RemoveNamespace::isRemovedNamespace(const NamespaceDecl *ND)
+{
+  const NamespaceDecl *CanonicalND = ND->getCanonicalDecl();
+  if (Mode == EMode::Flatten)
+    return FlattenedNamespaceNames.count(CanonicalND);
+  return (CanonicalND == TheNamespaceDecl);
+}
+
 bool RemoveNamespace::isTheNamespaceSpecifier(const NestedNameSpecifier *NNS)
 {
   NestedNameSpecifier::SpecifierKind Kind = NNS->getKind();
   switch (Kind) {
   case NestedNameSpecifier::Namespace: {
-    const NamespaceDecl *CanonicalND =
-      NNS->getAsNamespace()->getCanonicalDecl();
-    return (CanonicalND == TheNamespaceDecl);
+    return isRemovedNamespace(NNS->getAsNamespace());
   }
 
   case NestedNameSpecifier::NamespaceAlias: {
     const NamespaceAliasDecl *NAD = NNS->getAsNamespaceAlias();
-    // we remove the namealias only when it doesn't have nestedspecifier
-    if (NAD->getQualifier())
+    // we remove the namealias only when it doesn't have nestedspecifier,
+    // unless all the namespaces are flattened
+    if (NAD->getQualifier() && Mode == EMode::Remove)
       return false;
-    const NamespaceDecl *CanonicalND =
-      NAD->getNamespace()->getCanonicalDecl();
-    return (CanonicalND == TheNamespaceDecl);
+    return isRemovedNamespace(NAD->getNamespace());
   }
 
   default:
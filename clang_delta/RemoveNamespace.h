@@ -11,10 +11,15 @@
 #ifndef REMOVE_NAMESPACE_H
 #define REMOVE_NAMESPACE_H
 
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 #include "Transformation.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
 #include "clang/AST/NestedNameSpecifier.h"
 
 namespace clang {
@@ -37,9 +42,13 @@ friend class RemoveNamespaceASTVisitor;
 friend class RemoveNamespaceRewriteVisitor;
 
 public:
+  // Remove removes one namespace per instance; Flatten removes all the
+  // namespaces of the main file at once
+  enum class EMode { Remove, Flatten };
 
-  RemoveNamespace(const char *TransName, const char *Desc)
+  RemoveNamespace(const char *TransName, const char *Desc, EMode Mode)
     : Transformation(TransName, Desc),
+      Mode(Mode),
       CollectionVisitor(NULL),
       RewriteVisitor(NULL),
       TheNamespaceDecl(NULL),
@@ -63,6 +72,16 @@ private:
   typedef llvm::DenseMap<const clang::NamedDecl *, std::string>
             NamedDeclToNameMap;
 
+  typedef llvm::DenseMap<const clang::NamespaceDecl *, std::string>
+            NamespaceDeclToNameMap;
+
+  typedef llvm::MapVector<const clang::NamespaceDecl *,
+                          llvm::SmallVector<const clang::NamedDecl *, 4> >
+            NamespaceDeclToNamedDeclsMap;
+
+  typedef std::map<std::string, NamespaceDeclToNamedDeclsMap>
+            NameToNamespaceDeclsMap;
+
   virtual void Initialize(clang::ASTContext &context);
 
   virtual bool HandleTopLevelDecl(clang::DeclGroupRef D);
@@ -73,8 +92,28 @@ private:
 
   bool handleOneNamespaceDecl(clang::NamespaceDecl *ND);
 
+  void handleOneFlattenedNamespaceDecl(clang::NamespaceDecl *ND);
+
+  void addFlattenedNamedDecls(const clang::DeclContext *Ctx,
+                              const clang::NamespaceDecl *Owner);
+
+  void addFlattenedNamedDecl(const clang::NamedDecl *ND,
+                             const clang::NamespaceDecl *Owner);
+
+  const clang::NamespaceDecl *getFlattenedNamespace(const clang::Decl *D);
+
+  bool hasGlobalNameConflict(const clang::NamedDecl *ND);
+
+  std::string getUniqueFlattenedName(const std::string &Name);
+
+  void planFlattening(void);
+
+  bool isRemovedNamespace(const clang::NamespaceDecl *ND);
+
   void removeNamespace(const clang::NamespaceDecl *ND);
 
+  bool sharesRBraceWithParent(const clang::NamespaceDecl *ND);
+
   void removeUsingOrUsingDirectiveDecl(const clang::Decl *D);
 
   void handleOneNamedDecl(const clang::NamedDecl *ND, 
@@ -127,8 +166,29 @@ private:
 
   bool isSuffix(std::string &Name, std::string &SpecifierName);
 
+  const EMode Mode;
+
   NamespaceDeclSet VisitedND;
 
+  // In the Flatten mode, the canonical decls of the namespaces being
+  // removed, with the names their members are prefixed with
+  NamespaceDeclToNameMap FlattenedNamespaceNames;
+
+  // All the decls of the outermost namespaces being flattened, in source
+  // order
+  std::vector<const clang::NamespaceDecl *> TopLevelFlattenedDecls;
+
+  // All the decls of the namespaces being flattened, in source order
+  std::vector<const clang::NamespaceDecl *> FlattenedDecls;
+
+  // The names declared in the namespaces being flattened. A name is
+  // renamed in every namespace declaring it if it is declared by more
+  // than one of them, or if it is visible in the global scope.
+  NameToNamespaceDeclsMap FlattenedNames;
+
+  // The new names given to the flattened decls
+  std::set<std::string> FlattenedNewNames;
+
   UsingDeclSet UselessUsingDecls;
 
   UsingDirectiveDeclSet UselessUsingDirectiveDecls;
@@ -72,6 +72,7 @@ private:
 bool RNFCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
   if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD) ||
       !FD->isThisDeclarationADefinition())
     return true;
 
@@ -169,7 +169,7 @@ void RemovePointer::invalidateOneVarDecl(const DeclRefExpr *DRE)
 
 void RemovePointer::handleOneVarDecl(const VarDecl *VD)
 {
-  if (isInIncludedFile(VD))
+  if (isInIncludedFile(VD) || isOutsideRegions(VD))
     return;
 
   if (dyn_cast<ParmVarDecl>(VD))
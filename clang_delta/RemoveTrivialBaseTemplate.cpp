@@ -88,7 +88,8 @@ void RemoveTrivialBaseTemplate::HandleTranslationUnit(ASTContext &Ctx)
 void RemoveTrivialBaseTemplate::handleOneCXXRecordDecl(
        const CXXRecordDecl *CXXRD)
 {
-  if (isInIncludedFile(CXXRD) || isSpecialRecordDecl(CXXRD) ||
+  if (isInIncludedFile(CXXRD) ||
+      isOutsideRegions(CXXRD) || isSpecialRecordDecl(CXXRD) ||
       !CXXRD->hasDefinition())
     return;
 
@@ -48,7 +48,8 @@ private:
 bool RemoveTryCatchAnalysisVisitor::VisitCXXTryStmt(
        CXXTryStmt *CTS)
 {
-  if (ConsumerInstance->isInIncludedFile(CTS)) {
+  if (ConsumerInstance->isInIncludedFile(CTS) ||
+      ConsumerInstance->isOutsideRegions(CTS)) {
     return true;
   }
 
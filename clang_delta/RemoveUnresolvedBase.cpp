@@ -44,7 +44,8 @@ private:
 
 bool RemoveUnresolvedBaseASTVisitor::VisitCXXRecordDecl(CXXRecordDecl *CXXRD)
 {
-  if (ConsumerInstance->isInIncludedFile(CXXRD) || !CXXRD->hasDefinition())
+  if (ConsumerInstance->isInIncludedFile(CXXRD) ||
+      ConsumerInstance->isOutsideRegions(CXXRD) || !CXXRD->hasDefinition())
     return true;
 
   const CXXRecordDecl *CanonicalRD = CXXRD->getCanonicalDecl();
@@ -49,7 +49,8 @@ private:
 
 bool RemoveUnusedEnumMemberAnalysisVisitor::VisitEnumDecl(EnumDecl *ED)
 {
-  if (ConsumerInstance->isInIncludedFile(ED) || ED != ED->getCanonicalDecl())
+  if (ConsumerInstance->isInIncludedFile(ED) ||
+      ConsumerInstance->isOutsideRegions(ED) || ED != ED->getCanonicalDecl())
     return true;
 
   /* Make it backward compatible where --to-counter is unset. */
@@ -94,8 +95,9 @@ void RemoveUnusedEnumMember::HandleTranslationUnit(ASTContext &Ctx)
 
   Ctx.getDiagnostics().setSuppressAllDiagnostics(false);
 
+  int Index = TransformationCounter;
   for (auto ev : EnumValues) {
-    removeEnumConstantDecl(ev);
+    rewriteInstanceSafely(Index++, [this, ev]() { removeEnumConstantDecl(ev); });
   }
 
   if (Ctx.getDiagnostics().hasErrorOccurred() ||
@@ -197,7 +197,8 @@ bool ExtraReferenceVisitorWrapper::VisitFunctionDecl(FunctionDecl *FD)
 
 bool RUFAnalysisVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
-  if (ConsumerInstance->isInIncludedFile(FD))
+  if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD))
     return true;
   const FunctionDecl *CanonicalFD = FD->getCanonicalDecl();
   if (ConsumerInstance->VisitedFDs.count(CanonicalFD))
@@ -334,7 +335,7 @@ void RemoveUnusedFunction::doRewriting()
     const FunctionDecl *FD = AllValidFunctionDecls[I-1];
     TransAssert(FD && "NULL FunctionDecl!");
     RemovedFDs.insert(FD);
-    removeOneFunctionDeclGroup(FD);
+    rewriteInstanceSafely(I, [this, FD]() { removeOneFunctionDeclGroup(FD); });
   }
 }
 
@@ -61,6 +61,7 @@ bool RemoveUnusedOuterClassVisitor::VisitCXXRecordDecl(
        CXXRecordDecl *CXXRD)
 {
   if (ConsumerInstance->isInIncludedFile(CXXRD) ||
+      ConsumerInstance->isOutsideRegions(CXXRD) ||
       ConsumerInstance->isSpecialRecordDecl(CXXRD) ||
       !CXXRD->hasDefinition() ||
       dyn_cast<ClassTemplateSpecializationDecl>(CXXRD) ||
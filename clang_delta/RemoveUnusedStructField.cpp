@@ -68,7 +68,8 @@ private:
 
 bool RemoveUnusedStructFieldVisitor::VisitFieldDecl(FieldDecl *FD)
 {
-  if(ConsumerInstance->isInIncludedFile(FD))
+  if(ConsumerInstance->isInIncludedFile(FD) ||
+     ConsumerInstance->isOutsideRegions(FD))
     return true;
 
   const RecordDecl *RD = FD->getParent();
@@ -50,7 +50,8 @@ private:
 
 bool RemoveUnusedVarAnalysisVisitor::VisitVarDecl(VarDecl *VD)
 {
-  if (ConsumerInstance->isInIncludedFile(VD))
+  if (ConsumerInstance->isInIncludedFile(VD) ||
+      ConsumerInstance->isOutsideRegions(VD))
     return true;
 
   if (VD->isReferenced() || dyn_cast<ParmVarDecl>(VD) || 
@@ -156,7 +157,7 @@ void RemoveUnusedVar::doRewriting()
     TransAssert((I >= 1) && "Invalid Index!");
     const VarDecl *VD = AllValidVarDecls[I-1];
     TransAssert(VD && "NULL FunctionDecl!");
-    removeVarDecl(VD);
+    rewriteInstanceSafely(I, [this, VD]() { removeVarDecl(VD); });
   }
 }
 
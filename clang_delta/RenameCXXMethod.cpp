@@ -103,7 +103,8 @@ private:
 
 bool RenameCXXMethodCollectionVisitor::VisitCXXRecordDecl(CXXRecordDecl *RD)
 {
-  if (ConsumerInstance->isInIncludedFile(RD) || !RD->hasDefinition())
+  if (ConsumerInstance->isInIncludedFile(RD) ||
+      ConsumerInstance->isOutsideRegions(RD) || !RD->hasDefinition())
     return true;
   const CXXRecordDecl *RDDef = RD->getDefinition();
   ConsumerInstance->handleOneCXXRecordDecl(RDDef);
@@ -112,7 +113,8 @@ bool RenameCXXMethodCollectionVisitor::VisitCXXRecordDecl(CXXRecordDecl *RD)
 
 bool RenameCXXMethodCollectionVisitor::VisitCXXMethodDecl(CXXMethodDecl *MD)
 {
-  if (ConsumerInstance->isInIncludedFile(MD))
+  if (ConsumerInstance->isInIncludedFile(MD) ||
+      ConsumerInstance->isOutsideRegions(MD))
     return true;
   const CXXMethodDecl *CanonicalMD = MD->getCanonicalDecl();
   if(ConsumerInstance->NewMethodNames.find(CanonicalMD) != 
@@ -492,7 +494,7 @@ void RenameCXXMethod::handleOneCXXRecordDecl(const CXXRecordDecl *RD)
   }
 
   unsigned int NumFuns = getNumInheritedFunctions(RD);
-  CXXMethodDeclSet NonVirtualFuns;
+  CXXMethodDeclVector NonVirtualFuns;
   for (CXXRecordDecl::method_iterator I = RD->method_begin(),
        E = RD->method_end(); I != E; ++I) {
     const CXXMethodDecl *MD = (*I);
@@ -500,7 +502,7 @@ void RenameCXXMethod::handleOneCXXRecordDecl(const CXXRecordDecl *RD)
     if (isSpecialCXXMethod(MD))
       continue;
     if (!MD->isVirtual()) {
-      NonVirtualFuns.insert(MD);
+      NonVirtualFuns.push_back(MD);
       continue;
     }
 
@@ -518,7 +520,7 @@ void RenameCXXMethod::handleOneCXXRecordDecl(const CXXRecordDecl *RD)
   }
   const CXXRecordDecl *CanonicalRD = RD->getCanonicalDecl();
 
-  for (CXXMethodDeclSet::iterator MI = NonVirtualFuns.begin(),
+  for (CXXMethodDeclVector::iterator MI = NonVirtualFuns.begin(),
        ME = NonVirtualFuns.end(); MI != ME; ++MI) {
     NumFuns++;
     const CXXMethodDecl *MD = (*MI);
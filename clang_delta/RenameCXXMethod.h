@@ -76,6 +76,9 @@ private:
 
   typedef llvm::SmallPtrSet<const clang::CXXMethodDecl *, 10> CXXMethodDeclSet;
 
+  typedef llvm::SmallVector<const clang::CXXMethodDecl *, 10>
+    CXXMethodDeclVector;
+
   typedef llvm::SmallVector<const clang::ClassTemplateSpecializationDecl*, 5>
     ClassSpecDeclVector;
 
@@ -55,7 +55,7 @@ class RenameClassRewriteVisitor : public
 {
 public:
   RenameClassRewriteVisitor(Transformation *Instance,
-                            Rewriter *RT,
+                            EditRewriter *RT,
                             RewriteUtils *Helper,
                             const CXXRecordDecl *CXXRD,
                             const std::string &Name)
@@ -141,12 +141,14 @@ void RenameClass::doAnalysis(void)
     if (!RDSet)
       continue;
 
-    for (CXXRecordDeclSet::const_iterator I = RDSet->begin(),
-         E = RDSet->end(); I != E; ++I) {
+    CXXRecordDeclVector Records(RDSet->begin(), RDSet->end());
+    sortBySourceOrder(Records);
+    for (CXXRecordDeclVector::const_iterator I = Records.begin(),
+         E = Records.end(); I != E; ++I) {
       const CXXRecordDecl *CXXRD = (*I);
       if (UsedNameDecls.count(CXXRD->getCanonicalDecl()))
         continue;
-      if (isInIncludedFile(CXXRD))
+      if (isInIncludedFile(CXXRD) || isOutsideRegions(CXXRD))
         continue;
 
       incValidInstance(CXXRD);
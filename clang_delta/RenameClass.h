@@ -54,6 +54,9 @@ private:
 
   typedef llvm::SmallPtrSet<const clang::CXXRecordDecl *, 15> CXXRecordDeclSet;
 
+  typedef llvm::SmallVector<const clang::CXXRecordDecl *, 15>
+            CXXRecordDeclVector;
+
   typedef llvm::DenseMap<unsigned, CXXRecordDeclSet *> 
             InheritanceLevelToRecordsMap;
 
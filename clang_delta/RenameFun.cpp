@@ -76,6 +76,7 @@ bool RNFunCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 
   const FunctionDecl *CanonicalFD = FD->getCanonicalDecl();
   if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD) ||
       ConsumerInstance->isInIncludedFile(CanonicalFD))
     return true;
 
@@ -87,13 +88,15 @@ bool RNFunCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 
 bool RNFunCollectionVisitor::VisitCallExpr(CallExpr *CE)
 {
-  if (ConsumerInstance->isInIncludedFile(CE))
+  if (ConsumerInstance->isInIncludedFile(CE) ||
+      ConsumerInstance->isOutsideRegions(CE))
     return true;
   FunctionDecl *FD = CE->getDirectCallee();
   // It could happen, e.g., CE could refer to a DependentScopeDeclRefExpr
   if (!FD || dyn_cast<CXXMethodDecl>(FD) || FD->isOverloadedOperator())
     return true;
-  if (ConsumerInstance->isInIncludedFile(FD))
+  if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD))
     return true;
 
   const FunctionDecl *CanonicalFD = FD->getCanonicalDecl();
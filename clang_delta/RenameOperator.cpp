@@ -50,6 +50,7 @@ public:
 
     const FunctionDecl *CanonicalFD = FD->getCanonicalDecl();
     if (ConsumerInstance->isInIncludedFile(FD) ||
+        ConsumerInstance->isOutsideRegions(FD) ||
       ConsumerInstance->isInIncludedFile(CanonicalFD))
       return true;
 
@@ -91,7 +91,8 @@ bool ExistingVarCollectionVisitor::VisitVarDecl(VarDecl *VD)
 
 bool RenameParamVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
-  if (ConsumerInstance->isInIncludedFile(FD) || (FD->param_size() == 0))
+  if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD) || (FD->param_size() == 0))
     return true;
 
   FunctionDecl *CanonicalFD = FD->getCanonicalDecl();
@@ -67,7 +67,8 @@ private:
 
 bool RNVCollectionVisitor::VisitVarDecl(VarDecl *VD)
 {
-  if (ConsumerInstance->isInIncludedFile(VD))
+  if (ConsumerInstance->isInIncludedFile(VD) ||
+      ConsumerInstance->isOutsideRegions(VD))
     return true;
 
   ParmVarDecl *PV = dyn_cast<ParmVarDecl>(VD);
@@ -54,7 +54,8 @@ bool ReplaceArrayAccessWithIndex::IndexCollector::VisitArraySubscriptExpr(
   ArraySubscriptExpr *ASE)
 {
   // Skip expressions in included files.
-  if (ConsumerInstance->isInIncludedFile(ASE))
+  if (ConsumerInstance->isInIncludedFile(ASE) ||
+      ConsumerInstance->isOutsideRegions(ASE))
     return true;
 
   const VarDecl *BaseVD = getVarDeclFromExpr(ASE->getBase());
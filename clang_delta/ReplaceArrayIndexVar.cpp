@@ -15,6 +15,7 @@
 #include "ReplaceArrayIndexVar.h"
 
 #include <sstream>
+#include "llvm/ADT/MapVector.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/Basic/SourceManager.h"
@@ -36,7 +37,9 @@ static RegisterTransformation<ReplaceArrayIndexVar>
 typedef llvm::SmallPtrSet<const clang::ArraySubscriptExpr *, 10>
   ArraySubscriptExprSet;
 
-typedef llvm::DenseMap<const clang::VarDecl *, ArraySubscriptExprSet *>
+// Keep the arrays in the order they are visited, which numbers the
+// instances in source order
+typedef llvm::MapVector<const clang::VarDecl *, ArraySubscriptExprSet *>
   VarDeclToASESetMap;
 
 typedef llvm::DenseMap<const clang::VarDecl *, unsigned>
@@ -114,7 +117,8 @@ bool ReplaceArrayIndexVarCollectionVisitor::VisitVarDecl(VarDecl *VD)
 
 bool ReplaceArrayIndexVarCollectionVisitor::VisitForStmt(ForStmt *FS)
 {
-  if (ConsumerInstance->isInIncludedFile(FS))
+  if (ConsumerInstance->isInIncludedFile(FS) ||
+      ConsumerInstance->isOutsideRegions(FS))
     return true;
 
   const Expr *Inc = FS->getInc();
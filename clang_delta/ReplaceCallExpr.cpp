@@ -147,7 +147,8 @@ bool ReplaceCallExprVisitor::VisitReturnStmt(ReturnStmt *RS)
 
 bool ReplaceCallExprVisitor::VisitCallExpr(CallExpr *CE)
 {
-  if (ConsumerInstance->isInIncludedFile(CE))
+  if (ConsumerInstance->isInIncludedFile(CE) ||
+      ConsumerInstance->isOutsideRegions(CE))
     return true;
   FunctionDecl *FD = CE->getDirectCallee();
   if (!FD)
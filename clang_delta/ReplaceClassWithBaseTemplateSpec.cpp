@@ -51,6 +51,7 @@ bool ReplaceClassWithBaseTemplateSpecVisitor::VisitCXXRecordDecl(
        CXXRecordDecl *CXXRD)
 {
   if (ConsumerInstance->isInIncludedFile(CXXRD) ||
+      ConsumerInstance->isOutsideRegions(CXXRD) ||
       ConsumerInstance->isSpecialRecordDecl(CXXRD) ||
       !CXXRD->hasDefinition())
     return true;
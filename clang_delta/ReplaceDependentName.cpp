@@ -116,7 +116,7 @@ void ReplaceDependentName::handleOneElaboratedTypeLoc(
        const ElaboratedTypeLoc &TLoc)
 {
   SourceLocation Loc = TLoc.getBeginLoc();
-  if (Loc.isInvalid() || isInIncludedFile(Loc))
+  if (Loc.isInvalid() || isInIncludedFile(Loc) || isOutsideRegions(Loc))
     return;
 
   const ElaboratedType *ET = TLoc.getTypePtr();
@@ -155,7 +155,7 @@ void ReplaceDependentName::handleOneDependentNameTypeLoc(
        const DependentNameTypeLoc &TLoc)
 {
   SourceLocation Loc = TLoc.getBeginLoc();
-  if (Loc.isInvalid() || isInIncludedFile(Loc))
+  if (Loc.isInvalid() || isInIncludedFile(Loc) || isOutsideRegions(Loc))
     return;
 
   const DependentNameType *DNT = 
@@ -132,7 +132,8 @@ bool ReplaceDependentTypedef::isValidType(const QualType &QT)
 
 void ReplaceDependentTypedef::handleOneTypedefDecl(const TypedefNameDecl *D)
 {
-  if (isInIncludedFile(D) || D->getBeginLoc().isInvalid())
+  if (isInIncludedFile(D) ||
+      isOutsideRegions(D) || D->getBeginLoc().isInvalid())
     return;
 
   if (!isValidType(D->getUnderlyingType()))
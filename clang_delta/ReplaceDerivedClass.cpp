@@ -50,7 +50,7 @@ class ReplaceDerivedClassRewriteVisitor : public
 {
 public:
   ReplaceDerivedClassRewriteVisitor(Transformation *Instance,
-                                    Rewriter *RT,
+                                    EditRewriter *RT,
                                     RewriteUtils *Helper,
                                     const CXXRecordDecl *CXXRD,
                                     const std::string &Name)
@@ -139,7 +139,7 @@ bool ReplaceDerivedClass::isEmptyClass(const CXXRecordDecl *CXXDef)
 
 void ReplaceDerivedClass::handleOneCXXRecordDecl(const CXXRecordDecl *CXXRD)
 {
-  if (isInIncludedFile(CXXRD))
+  if (isInIncludedFile(CXXRD) || isOutsideRegions(CXXRD))
     return;
   const CXXRecordDecl *CXXDef = CXXRD->getDefinition();
   if (!CXXDef)
@@ -48,7 +48,8 @@ private:
 bool ReplaceFunctionDefWithDeclCollectionVisitor::VisitFunctionDecl(
        FunctionDecl *FD)
 {
-  if (ConsumerInstance->isInIncludedFile(FD))
+  if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD))
     return true;
 
   if (FD->isThisDeclarationADefinition() && 
@@ -308,7 +309,7 @@ void ReplaceFunctionDefWithDecl::doRewriting()
     TransAssert((I >= 1) && "Invalid Index!");
     const FunctionDecl *FD = AllValidFunctionDefs[I-1];
     TransAssert(FD && "NULL FunctionDecl!");
-    rewriteOneFunctionDef(FD);
+    rewriteInstanceSafely(I, [this, FD]() { rewriteOneFunctionDef(FD); });
   }
 }
 
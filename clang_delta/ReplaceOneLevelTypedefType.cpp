@@ -119,7 +119,8 @@ void ReplaceOneLevelTypedefType::removeTypedefs()
 
 void ReplaceOneLevelTypedefType::handleOneTypedefTypeLoc(TypedefTypeLoc TLoc)
 {
-  if (isInIncludedFile(TLoc.getBeginLoc()))
+  if (isInIncludedFile(TLoc.getBeginLoc()) ||
+      isOutsideRegions(TLoc.getBeginLoc()))
     return;
   const TypedefType *TdefTy = TLoc.getTypePtr();
   const TypedefNameDecl *TdefD = dyn_cast<TypedefNameDecl>(TdefTy->getDecl());
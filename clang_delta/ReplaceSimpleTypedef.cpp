@@ -67,7 +67,8 @@ private:
 
 bool ReplaceSimpleTypedefCollectionVisitor::VisitTypedefNameDecl(TypedefNameDecl*TdefD)
 {
-  if (ConsumerInstance->isInIncludedFile(TdefD))
+  if (ConsumerInstance->isInIncludedFile(TdefD) ||
+      ConsumerInstance->isOutsideRegions(TdefD))
     return true;
   TypedefNameDecl*CanonicalD = dyn_cast<TypedefNameDecl>(TdefD->getCanonicalDecl());
   if (!ConsumerInstance->VisitedTypedefDecls.count(CanonicalD)) {
@@ -65,7 +65,8 @@ private:
 
 bool ReplaceUndefFuncCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
-  if (ConsumerInstance->isInIncludedFile(FD) || FD->hasBody())
+  if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD) || FD->hasBody())
     return true;
   ConsumerInstance->handleOneFunctionDecl(FD->getCanonicalDecl());
 
@@ -69,7 +69,8 @@ private:
 
 bool RVCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
-  if (ConsumerInstance->isInIncludedFile(FD))
+  if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD))
     return true;
 
   FunctionDecl *CanonicalDecl = FD->getCanonicalDecl();
@@ -13,11 +13,11 @@
 #endif
 
 #include "RewriteUtils.h"
+#include "EditRewriter.h"
 
 #include <cctype>
 #include <sstream>
 #include "clang/Basic/SourceManager.h"
-#include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclTemplate.h"
@@ -33,7 +33,7 @@ RewriteUtils *RewriteUtils::Instance;
 
 const char *RewriteUtils::TmpVarNamePrefix = "__trans_tmp_";
 
-RewriteUtils *RewriteUtils::GetInstance(Rewriter *RW)
+RewriteUtils *RewriteUtils::GetInstance(EditRewriter *RW)
 {
   if (RewriteUtils::Instance) {
     RewriteUtils::Instance->TheRewriter = RW;
@@ -11,13 +11,16 @@
 #ifndef REWRITE_UTILS_H
 #define REWRITE_UTILS_H
 
+#include <cstdlib>
 #include <string>
 #include "clang/Basic/SourceLocation.h"
 #include "clang/AST/NestedNameSpecifier.h"
 #include "clang/AST/DeclTemplate.h"
 
+// A failed assertion raises SIGABRT rather than exiting, so that the crash
+// recovery of Transformation::rewriteInstanceSafely drops only the instance
 #ifndef ENABLE_TRANS_ASSERT
-  #define TransAssert(x) {if (!(x)) exit(-1);}
+  #define TransAssert(x) {if (!(x)) abort();}
 #else
   #define TransAssert(x) assert(x)
 #endif
@@ -53,9 +56,11 @@ namespace clang {
   class ValueDecl;
 }
 
+class EditRewriter;
+
 class RewriteUtils {
 public:
-  static RewriteUtils *GetInstance(clang::Rewriter *RW);
+  static RewriteUtils *GetInstance(EditRewriter *RW);
 
   static void Finalize(void);
 
@@ -290,7 +295,7 @@ private:
 
   static const char *TmpVarNamePrefix;
 
-  clang::Rewriter *TheRewriter;
+  EditRewriter *TheRewriter;
 
   clang::SourceManager *SrcManager;
 
@@ -0,0 +1,301 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012, 2013, 2015, 2016 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "ScalarizeAggregate.h"
+
+#include <sstream>
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
+
+#include "TransformationManager.h"
+
+using namespace clang;
+
+static const char *DescriptionMsg =
+"Replace a local or global struct variable with one scalar variable \
+per field if \n\
+  * all the fields of the struct are named scalars (no bit-fields); \n\
+  * the variable is only used to access its fields, i.e., its address \
+is never taken and it is never copied as a whole; \n\
+  * and it is declared alone in its declaration. \n\
+The initializer list of the variable is split among the new scalars, \
+and every field access is replaced with the corresponding scalar. \
+All the fields are scalarized at once, and a --to-counter range \
+scalarizes several variables in one run. \n";
+
+static RegisterTransformation<ScalarizeAggregate>
+         Trans("scalarize-aggregate", DescriptionMsg);
+
+class ScalarizeAggregateCollectionVisitor : public
+  RecursiveASTVisitor<ScalarizeAggregateCollectionVisitor> {
+public:
+
+  explicit ScalarizeAggregateCollectionVisitor(ScalarizeAggregate *Instance)
+    : ConsumerInstance(Instance)
+  { }
+
+  bool VisitCompoundStmt(CompoundStmt *CS);
+
+  bool VisitMemberExpr(MemberExpr *ME);
+
+  bool VisitDeclRefExpr(DeclRefExpr *DRE);
+
+private:
+
+  ScalarizeAggregate *ConsumerInstance;
+};
+
+// Only the declarations directly in a block can be split into several
+// ones, e.g., not the ones in the init statement of a for loop
+bool ScalarizeAggregateCollectionVisitor::VisitCompoundStmt(CompoundStmt *CS)
+{
+  for (Stmt *S : CS->body()) {
+    DeclStmt *DS = dyn_cast<DeclStmt>(S);
+    if (!DS || !DS->isSingleDecl())
+      continue;
+    if (const VarDecl *VD = dyn_cast<VarDecl>(DS->getSingleDecl()))
+      ConsumerInstance->addCandidate(VD);
+  }
+  return true;
+}
+
+bool ScalarizeAggregateCollectionVisitor::VisitMemberExpr(MemberExpr *ME)
+{
+  if (ME->isArrow() || !isa<FieldDecl>(ME->getMemberDecl()))
+    return true;
+
+  const DeclRefExpr *DRE =
+    dyn_cast<DeclRefExpr>(ME->getBase()->IgnoreParens());
+  if (!DRE)
+    return true;
+  if (const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl()))
+    ConsumerInstance->VarToMemberExprs[VD].push_back(ME);
+  return true;
+}
+
+bool ScalarizeAggregateCollectionVisitor::VisitDeclRefExpr(DeclRefExpr *DRE)
+{
+  if (const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl()))
+    ConsumerInstance->VarToNumRefs[VD]++;
+  return true;
+}
+
+void ScalarizeAggregate::Initialize(ASTContext &context)
+{
+  Transformation::Initialize(context);
+  CollectionVisitor = new ScalarizeAggregateCollectionVisitor(this);
+}
+
+bool ScalarizeAggregate::HandleTopLevelDecl(DeclGroupRef D)
+{
+  if (D.isSingleDecl()) {
+    if (const VarDecl *VD = dyn_cast<VarDecl>(D.getSingleDecl()))
+      addCandidate(VD);
+  }
+
+  for (DeclGroupRef::iterator I = D.begin(), E = D.end(); I != E; ++I) {
+    CollectionVisitor->TraverseDecl(*I);
+  }
+  return true;
+}
+
+void ScalarizeAggregate::HandleTranslationUnit(ASTContext &Ctx)
+{
+  sortBySourceOrder(Candidates);
+  for (const VarDecl *VD : Candidates) {
+    if (isValidCandidate(VD))
+      ValidVarDecls.push_back(VD);
+  }
+  ValidInstanceNum = ValidVarDecls.size();
+
+  if (QueryInstanceOnly)
+    return;
+
+  if (TransformationCounter > ValidInstanceNum) {
+    TransError = TransMaxInstanceError;
+    return;
+  }
+  if (ToCounter > ValidInstanceNum) {
+    TransError = TransToCounterTooBigError;
+    return;
+  }
+
+  Ctx.getDiagnostics().setSuppressAllDiagnostics(false);
+
+  doRewriting();
+
+  if (Ctx.getDiagnostics().hasErrorOccurred() ||
+      Ctx.getDiagnostics().hasFatalErrorOccurred())
+    TransError = TransInternalError;
+}
+
+bool ScalarizeAggregate::isScalarizableRecord(const RecordDecl *RD)
+{
+  RD = RD->getDefinition();
+  if (!RD || RD->isUnion() || RD->field_empty())
+    return false;
+  if (const CXXRecordDecl *CXXRD = dyn_cast<CXXRecordDecl>(RD)) {
+    if (!CXXRD->isCLike())
+      return false;
+  }
+
+  for (const FieldDecl *FD : RD->fields()) {
+    if (FD->isBitField() || !FD->getIdentifier() ||
+        !FD->getType()->isScalarType())
+      return false;
+  }
+  return true;
+}
+
+void ScalarizeAggregate::addCandidate(const VarDecl *VD)
+{
+  if (isInIncludedFile(VD) ||
+      isOutsideRegions(VD) || VD->getLocation().isMacroID() ||
+      VD->hasExternalStorage() || VD->getTSCSpec() != TSCS_unspecified)
+    return;
+
+  const RecordType *RT = VD->getType()->getAs<RecordType>();
+  if (!RT || !isScalarizableRecord(RT->getDecl()))
+    return;
+  Candidates.push_back(VD);
+}
+
+// Every reference to the variable must be a field access, and the
+// variable must be declared once, e.g., not as a tentative definition
+// followed by another one.
+bool ScalarizeAggregate::isValidCandidate(const VarDecl *VD)
+{
+  if (VD->getPreviousDecl() || VD->getMostRecentDecl() != VD)
+    return false;
+
+  const Expr *Init = VD->getInit();
+  if (Init && !isa<InitListExpr>(Init))
+    return false;
+
+  const MemberExprVector &MEs = VarToMemberExprs[VD];
+  if (MEs.size() != VarToNumRefs[VD])
+    return false;
+  for (const MemberExpr *ME : MEs) {
+    if (isInIncludedFile(ME) || ME->getBeginLoc().isMacroID() ||
+        ME->getEndLoc().isMacroID())
+      return false;
+  }
+  return true;
+}
+
+void ScalarizeAggregate::getScalarName(const VarDecl *VD,
+                                       const FieldDecl *FD,
+                                       std::string &Name)
+{
+  Name = VD->getNameAsString() + "_" + FD->getNameAsString();
+}
+
+// The scalar must not hide or clash with any other name of the translation
+// unit, nor with the scalars of the other variables of a --to-counter range
+std::string ScalarizeAggregate::getUniqueScalarName(const VarDecl *VD,
+                                                    const FieldDecl *FD)
+{
+  std::string Name;
+  getScalarName(VD, FD, Name);
+  std::string NewName = Name;
+  for (unsigned Postfix = 1; ; ++Postfix) {
+    if ((Context->Idents.find(NewName) == Context->Idents.end()) &&
+        ScalarNames.insert(NewName).second)
+      return NewName;
+    std::stringstream TmpSS;
+    TmpSS << Name << "_" << Postfix;
+    NewName = TmpSS.str();
+  }
+}
+
+// Return false if the scalar of the field Idx doesn't need an initializer
+bool ScalarizeAggregate::getFieldInitStr(const VarDecl *VD, unsigned Idx,
+                                         std::string &InitStr)
+{
+  const InitListExpr *ILE = dyn_cast_or_null<InitListExpr>(VD->getInit());
+  if (!ILE)
+    return false;
+  if (!ILE->isSemanticForm())
+    ILE = ILE->getSemanticForm();
+
+  if (Idx < ILE->getNumInits()) {
+    const Expr *E = ILE->getInit(Idx);
+    if (!isa<ImplicitValueInitExpr>(E) && E->getBeginLoc().isValid()) {
+      RewriteHelper->getExprString(E, InitStr);
+      return true;
+    }
+  }
+
+  // the fields without an initializer are zero-initialized
+  InitStr = "0";
+  return true;
+}
+
+void ScalarizeAggregate::scalarizeVarDecl(const VarDecl *VD)
+{
+  const RecordDecl *RD =
+    VD->getType()->getAs<RecordType>()->getDecl()->getDefinition();
+  TransAssert(RD && "Incomplete aggregate type!");
+  unsigned Quals =
+    Context->getCanonicalType(VD->getType()).getCVRQualifiers();
+
+  llvm::DenseMap<const FieldDecl *, std::string> FieldToName;
+  std::string DeclsStr;
+  unsigned Idx = 0;
+  for (const FieldDecl *FD : RD->fields()) {
+    std::string VarStr = getUniqueScalarName(VD, FD);
+    FieldToName[FD] = VarStr;
+    QualType QT = FD->getType().withCVRQualifiers(Quals);
+    QT.getAsStringInternal(VarStr, getPrintingPolicy());
+
+    std::string InitStr;
+    if (getFieldInitStr(VD, Idx++, InitStr))
+      VarStr += " = " + InitStr;
+    if (VD->getStorageClass() == SC_Static)
+      VarStr = "static " + VarStr;
+
+    if (!DeclsStr.empty())
+      DeclsStr += " ";
+    DeclsStr += VarStr + ";";
+  }
+  TheRewriter.ReplaceText(RewriteHelper->getDeclFullSourceRange(VD),
+                          DeclsStr);
+
+  for (const MemberExpr *ME : VarToMemberExprs[VD]) {
+    const FieldDecl *FD = cast<FieldDecl>(ME->getMemberDecl());
+    RewriteHelper->replaceExpr(ME, FieldToName[FD]);
+  }
+}
+
+void ScalarizeAggregate::doRewriting(void)
+{
+  if (ToCounter <= 0) {
+    scalarizeVarDecl(ValidVarDecls[TransformationCounter - 1]);
+    return;
+  }
+
+  TransAssert((ToCounter <= static_cast<int>(ValidVarDecls.size())) &&
+              "ToCounter is larger than the number of decls!");
+  for (int I = ToCounter; I >= TransformationCounter; --I) {
+    TransAssert((I >= 1) && "Invalid Index!");
+    const VarDecl *VD = ValidVarDecls[I-1];
+    rewriteInstanceSafely(I, [this, VD]() { scalarizeVarDecl(VD); });
+  }
+}
+
+ScalarizeAggregate::~ScalarizeAggregate(void)
+{
+  delete CollectionVisitor;
+}
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (c) 2012, 2013, 2016 The University of Utah
+// All rights reserved.
+//
+// This file is distributed under the University of Illinois Open Source
+// License.  See the file COPYING for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SCALARIZE_AGGREGATE_H
+#define SCALARIZE_AGGREGATE_H
+
+#include <set>
+#include <string>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "Transformation.h"
+
+namespace clang {
+  class DeclGroupRef;
+  class ASTContext;
+  class VarDecl;
+  class MemberExpr;
+  class RecordDecl;
+  class FieldDecl;
+}
+
+class ScalarizeAggregateCollectionVisitor;
+
+class ScalarizeAggregate : public Transformation {
+friend class ScalarizeAggregateCollectionVisitor;
+
+public:
+
+  ScalarizeAggregate(const char *TransName, const char *Desc)
+    : Transformation(TransName, Desc, /*MultipleRewrites*/true),
+      CollectionVisitor(NULL)
+  { }
+
+  ~ScalarizeAggregate(void);
+
+private:
+  typedef llvm::SmallVector<const clang::MemberExpr *, 8> MemberExprVector;
+
+  virtual void Initialize(clang::ASTContext &context);
+
+  virtual bool HandleTopLevelDecl(clang::DeclGroupRef D);
+
+  virtual void HandleTranslationUnit(clang::ASTContext &Ctx);
+
+  void addCandidate(const clang::VarDecl *VD);
+
+  bool isScalarizableRecord(const clang::RecordDecl *RD);
+
+  bool isValidCandidate(const clang::VarDecl *VD);
+
+  void getScalarName(const clang::VarDecl *VD, const clang::FieldDecl *FD,
+                     std::string &Name);
+
+  std::string getUniqueScalarName(const clang::VarDecl *VD,
+                                  const clang::FieldDecl *FD);
+
+  bool getFieldInitStr(const clang::VarDecl *VD, unsigned Idx,
+                       std::string &InitStr);
+
+  void scalarizeVarDecl(const clang::VarDecl *VD);
+
+  void doRewriting(void);
+
+  // Single declarations of aggregate variables, in source order
+  llvm::SmallVector<const clang::VarDecl *, 16> Candidates;
+
+  // All the accesses to the fields of a candidate
+  llvm::DenseMap<const clang::VarDecl *, MemberExprVector> VarToMemberExprs;
+
+  // Number of references to a candidate, including the ones in
+  // VarToMemberExprs
+  llvm::DenseMap<const clang::VarDecl *, unsigned> VarToNumRefs;
+
+  llvm::SmallVector<const clang::VarDecl *, 16> ValidVarDecls;
+
+  // The names of the scalars introduced so far
+  std::set<std::string> ScalarNames;
+
+  ScalarizeAggregateCollectionVisitor *CollectionVisitor;
+
+  // Unimplemented
+  ScalarizeAggregate(void);
+
+  ScalarizeAggregate(const ScalarizeAggregate &);
+
+  void operator=(const ScalarizeAggregate &);
+};
+#endif
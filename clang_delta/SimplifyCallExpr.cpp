@@ -64,7 +64,8 @@ private:
 
 bool SimplifyCallExprVisitor::VisitCallExpr(CallExpr *CE)
 {
-  if (ConsumerInstance->isInIncludedFile(CE))
+  if (ConsumerInstance->isInIncludedFile(CE) ||
+      ConsumerInstance->isOutsideRegions(CE))
     return true;
 
   ConsumerInstance->ValidInstanceNum++;
@@ -71,6 +71,7 @@ private:
 bool SimplifyCommaExprCollectionVisitor::VisitFunctionDecl(FunctionDecl *FD)
 {
   if (ConsumerInstance->isInIncludedFile(FD) ||
+      ConsumerInstance->isOutsideRegions(FD) ||
       !FD->isThisDeclarationADefinition())
     return true;
 
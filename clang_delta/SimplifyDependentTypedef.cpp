@@ -161,7 +161,7 @@ void SimplifyDependentTypedef::rewriteTypedefDecl(void)
 
 void SimplifyDependentTypedef::handleOneTypedefDecl(const TypedefNameDecl *D)
 {
-  if (isInIncludedFile(D))
+  if (isInIncludedFile(D) || isOutsideRegions(D))
     return;
 
   const TypedefNameDecl *CanonicalD = dyn_cast<TypedefNameDecl>(D->getCanonicalDecl());
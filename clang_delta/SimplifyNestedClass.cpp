@@ -55,6 +55,7 @@ bool SimplifyNestedClassVisitor::VisitCXXRecordDecl(
        CXXRecordDecl *CXXRD)
 {
   if (ConsumerInstance->isInIncludedFile(CXXRD) ||
+      ConsumerInstance->isOutsideRegions(CXXRD) ||
       ConsumerInstance->isSpecialRecordDecl(CXXRD) || !CXXRD->hasDefinition())
     return true;
   ConsumerInstance->handleOneCXXRecordDecl(CXXRD->getDefinition());
@@ -137,7 +137,8 @@ void
 SimplifyRecursiveTemplateInstantiation::handleTemplateSpecializationTypeLoc(
        const TemplateSpecializationTypeLoc &TLoc)
 {
-  if (isInIncludedFile(TLoc.getBeginLoc()))
+  if (isInIncludedFile(TLoc.getBeginLoc()) ||
+      isOutsideRegions(TLoc.getBeginLoc()))
     return;
   for (unsigned I = 0; I < TLoc.getNumArgs(); ++I) {
     TemplateArgumentLoc ArgLoc = TLoc.getArgLoc(I);
@@ -78,7 +78,8 @@ private:
 
 bool SimplifyStructCollectionVisitor::VisitRecordDecl(RecordDecl *RD)
 {
-  if (ConsumerInstance->isInIncludedFile(RD))
+  if (ConsumerInstance->isInIncludedFile(RD) ||
+      ConsumerInstance->isOutsideRegions(RD))
     return true;
   if (!RD->isThisDeclarationADefinition() || !RD->isStruct())
     return true;
@@ -79,7 +79,7 @@ void SimplifyStructUnionDecl::Initialize(ASTContext &context)
 bool SimplifyStructUnionDecl::HandleTopLevelDecl(DeclGroupRef DGR) 
 {
   DeclGroupRef::iterator DI = DGR.begin();
-  if (isInIncludedFile(*DI))
+  if (isInIncludedFile(*DI) || isOutsideRegions(*DI))
     return true;
 
   const RecordDecl *RD = dyn_cast<RecordDecl>(*DI);
@@ -263,7 +263,8 @@ void TemplateArgToInt::handleOneTemplateArgumentLoc(
        const TemplateArgumentLoc &ArgLoc)
 {
   if (ArgLoc.getLocation().isInvalid() ||
-      isInIncludedFile(ArgLoc.getLocation()))
+      isInIncludedFile(ArgLoc.getLocation()) ||
+      isOutsideRegions(ArgLoc.getLocation()))
     return;
   const TemplateArgument &Arg = ArgLoc.getArgument();
 
@@ -227,7 +227,7 @@ bool TemplateNonTypeArgToInt::isValidParameter(const NamedDecl *ND)
       
 void TemplateNonTypeArgToInt::handleOneTemplateDecl(const TemplateDecl *D)
 {
-  if (isInIncludedFile(D))
+  if (isInIncludedFile(D) || isOutsideRegions(D))
     return;
   TemplateParameterIdxSet *ValidParamIdx = new TemplateParameterIdxSet();
   TemplateParameterList *TPList = D->getTemplateParameters();
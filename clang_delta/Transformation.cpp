@@ -14,6 +14,7 @@
 
 #include "Transformation.h"
 
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -21,6 +22,7 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
@@ -98,14 +100,39 @@ void Transformation::Initialize(ASTContext &context)
 void Transformation::outputTransformedSource(llvm::raw_ostream &OutStream)
 {
   FileID MainFileID = SrcManager->getMainFileID();
-  const RewriteBuffer *RWBuf = TheRewriter.getRewriteBufferFor(MainFileID);
-
-  // RWBuf is non-empty upon any rewrites
-  TransAssert(RWBuf && "Empty RewriteBuffer!");
-  OutStream << std::string(RWBuf->begin(), RWBuf->end());
+  // The main file is changed upon any rewrites
+  bool Changed = TheRewriter.write(MainFileID, OutStream);
+  TransAssert(Changed && "Empty RewriteBuffer!");
   OutStream.flush();
 }
 
+void Transformation::rewriteInstanceSafely(int Index,
+                                           llvm::function_ref<void()> Rewrite)
+{
+  TheRewriter.checkpoint();
+  llvm::CrashRecoveryContext CRC;
+  if (CRC.RunSafely(Rewrite)) {
+    TheRewriter.commit();
+    return;
+  }
+
+  // The instance may have made only a part of its edits. If they can't be
+  // discarded, the original source is output.
+  if (!TheRewriter.rollback())
+    TransError = TransInternalError;
+  CrashedInstances.push_back(Index);
+  if (!CrashSignature.empty())
+    return;
+
+  std::stringstream SS;
+  SS << "crash in " << Name << " instance " << Index;
+#if LLVM_VERSION_MAJOR >= 11
+  if (CRC.RetCode > 128)
+    SS << ": " << strsignal(CRC.RetCode - 128);
+#endif
+  CrashSignature = SS.str();
+}
+
 void Transformation::outputOriginalSource(llvm::raw_ostream &OutStream)
 {
   FileID MainFileID = SrcManager->getMainFileID();
@@ -1128,6 +1155,49 @@ bool Transformation::isInIncludedFile(const Stmt *S) const
   return isInIncludedFile(S->getBeginLoc());
 }
 
+bool Transformation::isOutsideRegions(SourceRange Range) const
+{
+  if (Regions.empty())
+    return false;
+
+  FileID MainFileID = SrcManager->getMainFileID();
+  std::pair<FileID, unsigned> Begin =
+    SrcManager->getDecomposedLoc(getRealLocation(Range.getBegin()));
+  std::pair<FileID, unsigned> End =
+    SrcManager->getDecomposedLoc(getRealLocation(Range.getEnd()));
+  if (Begin.first != MainFileID)
+    return true;
+  if (End.first != MainFileID || End.second < Begin.second)
+    End.second = Begin.second;
+
+  for (const std::pair<unsigned, unsigned> &Region : Regions) {
+    if (Region.first <= End.second && Begin.second < Region.second)
+      return false;
+  }
+  return true;
+}
+
+bool Transformation::isOutsideRegions(const Decl *D) const
+{
+  return isOutsideRegions(D->getSourceRange());
+}
+
+bool Transformation::isOutsideRegions(const Stmt *S) const
+{
+  return isOutsideRegions(S->getSourceRange());
+}
+
+bool Transformation::isBeforeInSource(const Decl *D1, const Decl *D2) const
+{
+  SourceLocation Loc1 = D1->getLocation();
+  SourceLocation Loc2 = D2->getLocation();
+  if (Loc1.isInvalid() || Loc2.isInvalid())
+    return Loc1.isInvalid() && Loc2.isValid();
+  if (Loc1 == Loc2)
+    return false;
+  return SrcManager->isBeforeInTranslationUnit(Loc1, Loc2);
+}
+
 SourceLocation Transformation::getRealLocation(const SourceLocation& Loc) const
 {
   if (Loc.isMacroID())
@@ -14,10 +14,15 @@
 #include <string>
 #include <cstdlib>
 #include <cassert>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/PrettyPrinter.h"
-#include "clang/Rewrite/Core/Rewriter.h"
+#include "EditRewriter.h"
 #include "RewriteUtils.h"
 
 namespace clang {
@@ -138,6 +143,12 @@ public:
     WarnOnCounterOutOfBounds = Flag;
   }
 
+  // Limit the instances to the ones in the byte range [Offset,
+  // Offset + Length) of the main file, or in any other added range
+  void addRegion(unsigned Offset, unsigned Length) {
+    Regions.push_back(std::make_pair(Offset, Offset + Length));
+  }
+
   bool isMultipleRewritesEnabled() {
     return MultipleRewrites;
   }
@@ -194,6 +205,20 @@ public:
     return false;
   }
 
+  // Return true if the transformation watches the preprocessor, so that
+  // it can't run on a loaded AST snapshot
+  virtual bool usesPreprocessorCallbacks() {
+    return false;
+  }
+
+  const std::vector<int> &getCrashedInstances() {
+    return CrashedInstances;
+  }
+
+  const std::string &getCrashSignature() {
+    return CrashSignature;
+  }
+
 protected:
 
   typedef llvm::SmallVector<unsigned int, 10> IndexVector;
@@ -323,6 +348,22 @@ protected:
 
   bool isInIncludedFile(const clang::Stmt *S) const;
 
+  // Return true if the code doesn't touch any of the regions given with
+  // addRegion. The collection visitors skip such code, so that its
+  // instances are neither counted nor transformed. A declaration or
+  // statement partly in a region is kept, so that the instances nested in
+  // it can be reached. The uses and redeclarations of an instance are still
+  // rewritten outside the regions.
+  bool isOutsideRegions(clang::SourceRange Range) const;
+
+  bool isOutsideRegions(clang::SourceLocation Loc) const {
+    return isOutsideRegions(clang::SourceRange(Loc, Loc));
+  }
+
+  bool isOutsideRegions(const clang::Decl *D) const;
+
+  bool isOutsideRegions(const clang::Stmt *S) const;
+
   bool isDeclaringRecordDecl(const clang::RecordDecl *RD);
 
   clang::PrintingPolicy getPrintingPolicy() const;
@@ -332,6 +373,27 @@ protected:
   clang::SourceLocation getRealLocation(const clang::SourceLocation& Loc) const;
   clang::SourceRange getRealLocation(const clang::SourceRange& Range) const;
 
+  // Return true if D1 is located before D2 in the translation unit.
+  // Declarations without a valid location come first.
+  bool isBeforeInSource(const clang::Decl *D1, const clang::Decl *D2) const;
+
+  // Instances must be numbered in source order, so that a counter selects
+  // the same instance in every run. The iteration order of pointer-keyed
+  // sets and maps depends on the heap layout, so the declarations
+  // collected into them have to be sorted with this before being counted.
+  template<typename DeclTy>
+  void sortBySourceOrder(llvm::SmallVectorImpl<const DeclTy *> &Decls) const {
+    std::stable_sort(Decls.begin(), Decls.end(),
+                     [this](const DeclTy *D1, const DeclTy *D2) {
+                       return isBeforeInSource(D1, D2);
+                     });
+  }
+
+  // Rewrite the instance Index of a --to-counter range. If Rewrite crashes,
+  // its edits are discarded and the instance is recorded as crashed, so
+  // that the rest of the range can still be rewritten.
+  void rewriteInstanceSafely(int Index, llvm::function_ref<void()> Rewrite);
+
   const std::string Name;
 
   int TransformationCounter;
@@ -346,7 +408,7 @@ protected:
 
   clang::Preprocessor *PP;
 
-  clang::Rewriter TheRewriter;
+  EditRewriter TheRewriter;
 
   TransformationError TransError;
   
@@ -373,6 +435,14 @@ protected:
   std::string ReferenceValue;
 
   bool WarnOnCounterOutOfBounds;
+
+  // [Begin, End) byte ranges of the main file, all of it if empty
+  std::vector<std::pair<unsigned, unsigned> > Regions;
+
+  std::vector<int> CrashedInstances;
+
+  // Description of the first crash
+  std::string CrashSignature;
 };
 
 class TransNameQueryVisitor;
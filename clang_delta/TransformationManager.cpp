@@ -14,9 +14,16 @@
 
 #include "TransformationManager.h"
 
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 #include <sstream>
 
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclGroup.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
@@ -25,9 +32,25 @@
 #include "clang/Basic/LangStandard.h"
 #endif
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/Version.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/Utils.h"
 #include "clang/Parse/ParseAST.h"
+#include "clang/Serialization/ASTWriter.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/Bitstream/BitstreamWriter.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/StringSaver.h"
 
 #include "Transformation.h"
 
@@ -36,8 +59,44 @@ using namespace clang;
 
 int TransformationManager::ErrorInvalidCounter = 1;
 
+int TransformationManager::ErrorCrashedInstances = 2;
+
+int TransformationManager::ErrorCrashedTransformation = 3;
+
+int TransformationManager::ErrorFailedPipelineSteps = 4;
+
 TransformationManager* TransformationManager::Instance;
 
+namespace {
+
+// Look for the instantiated definitions of function and variable templates,
+// which ParseAST passes to the consumer as top-level declarations
+class InstantiationFinder : public RecursiveASTVisitor<InstantiationFinder> {
+public:
+  bool shouldVisitTemplateInstantiations() const { return true; }
+
+  bool VisitFunctionDecl(FunctionDecl *FD) {
+    Found = FD->isTemplateInstantiation() &&
+            FD->doesThisDeclarationHaveABody();
+    return !Found;
+  }
+
+  bool VisitVarDecl(VarDecl *VD) {
+    Found = isTemplateInstantiation(VD->getTemplateSpecializationKind());
+    return !Found;
+  }
+
+  bool Found = false;
+};
+
+// Collect the system headers too, they may come from CVISE_INCLUDE_PATH
+class IncludedFilesCollectorImpl : public DependencyCollector {
+public:
+  bool needSystemDependencies() override { return true; }
+};
+
+} // end anonymous namespace
+
 std::map<std::string, Transformation *> *
 TransformationManager::TransformationsMapPtr;
 
@@ -86,6 +145,374 @@ bool TransformationManager::isOpenCLLangOpt()
           .OpenCL);
 }
 
+static void getAbsolutePath(StringRef Dir, StringRef File,
+                            llvm::SmallVectorImpl<char> &Path)
+{
+  Path.clear();
+  if (llvm::sys::path::is_relative(File))
+    Path.append(Dir.begin(), Dir.end());
+  llvm::sys::path::append(Path, File);
+  llvm::sys::path::remove_dots(Path, true);
+}
+
+// Add the flags of the source file's entry in the compilation database to
+// CompilerArgs. A file reduced by C-Vise is a copy in a temporary directory,
+// so the first entry of a file with the same name is used if there is no
+// entry for the source file itself. Without any entry, the file is parsed
+// with the default options.
+bool TransformationManager::readCompileCommand(std::string &ErrorMsg)
+{
+  llvm::SmallString<256> DBPath(CompileCommandsFileName);
+  if (llvm::sys::fs::is_directory(DBPath))
+    llvm::sys::path::append(DBPath, "compile_commands.json");
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+    llvm::MemoryBuffer::getFile(DBPath);
+  if (!Buffer) {
+    ErrorMsg = "Cannot open compilation database!";
+    return false;
+  }
+  llvm::Expected<llvm::json::Value> DB =
+    llvm::json::parse((*Buffer)->getBuffer());
+  if (!DB) {
+    llvm::consumeError(DB.takeError());
+    ErrorMsg = "Cannot parse compilation database!";
+    return false;
+  }
+  const llvm::json::Array *Entries = DB->getAsArray();
+  if (!Entries) {
+    ErrorMsg = "Invalid compilation database!";
+    return false;
+  }
+
+  llvm::SmallString<256> SrcPath(SrcFileName);
+  llvm::sys::fs::make_absolute(SrcPath);
+  llvm::sys::path::remove_dots(SrcPath, true);
+
+  const llvm::json::Object *Command = NULL;
+  llvm::SmallString<256> CommandPath, Path;
+  for (const llvm::json::Value &Value : *Entries) {
+    const llvm::json::Object *Entry = Value.getAsObject();
+    if (!Entry)
+      continue;
+    auto File = Entry->getString("file");
+    auto Dir = Entry->getString("directory");
+    if (!File)
+      continue;
+
+    getAbsolutePath(Dir ? *Dir : StringRef(), *File, Path);
+    bool SameFile = (Path.str() == SrcPath.str());
+    if (SameFile || (!Command && llvm::sys::path::filename(Path) ==
+                                 llvm::sys::path::filename(SrcPath))) {
+      Command = Entry;
+      CommandPath = Path;
+      if (SameFile)
+        break;
+    }
+  }
+  if (!Command)
+    return true;
+
+  llvm::BumpPtrAllocator Alloc;
+  llvm::StringSaver Saver(Alloc);
+  llvm::SmallVector<const char *, 64> Argv;
+  if (const llvm::json::Array *Arguments = Command->getArray("arguments")) {
+    for (const llvm::json::Value &Value : *Arguments) {
+      if (auto Arg = Value.getAsString())
+        Argv.push_back(Saver.save(*Arg).data());
+    }
+  }
+  else if (auto CommandLine = Command->getString("command")) {
+    llvm::cl::TokenizeGNUCommandLine(*CommandLine, Saver, Argv);
+  }
+
+  std::vector<std::string> Args;
+  auto Dir = Command->getString("directory");
+  if (Dir) {
+    Args.push_back("-working-directory");
+    Args.push_back(Dir->str());
+  }
+  // Skip the compiler, the input, the output and the dependency file
+  // generation
+  for (size_t I = 1; I < Argv.size(); ++I) {
+    StringRef Arg(Argv[I]);
+    if (Arg == "-o" || Arg == "-MF" || Arg == "-MT" || Arg == "-MQ" ||
+        Arg == "-MJ") {
+      ++I;
+      continue;
+    }
+    if (Arg == "-c" || Arg == "-S" || Arg == "-E" || Arg.substr(0, 2) == "-M")
+      continue;
+    if (!Arg.empty() && Arg[0] != '-') {
+      getAbsolutePath(Dir ? *Dir : StringRef(), Arg, Path);
+      if (Path.str() == CommandPath.str())
+        continue;
+    }
+    Args.push_back(Arg.str());
+  }
+
+  // The flags given on the command line come last
+  CompilerArgs.insert(CompilerArgs.begin(), Args.begin(), Args.end());
+  return true;
+}
+
+// Let the clang driver translate the flags, so that any flag of a real
+// build (e.g., -isystem, -f, -m or --target ones) can be given.
+bool TransformationManager::createInvocationFromCompilerArgs(
+       bool IsCXX, std::string &ErrorMsg)
+{
+  // The flags may change the working directory
+  llvm::SmallString<256> SrcPath(SrcFileName);
+  llvm::sys::fs::make_absolute(SrcPath);
+  SrcFileName = std::string(SrcPath.str());
+
+  std::vector<std::string> Args(1, "clang");
+  Args.insert(Args.end(), CompilerArgs.begin(), CompilerArgs.end());
+  if (const char *env = getenv("CVISE_TARGET_TRIPLE"))
+    Args.push_back(std::string("--target=") + env);
+  if (SetCXXStandard && IsCXX)
+    Args.push_back("-std=" + CXXStandard);
+  Args.push_back("-fsyntax-only");
+  Args.push_back(SrcFileName);
+
+  std::vector<const char *> Argv;
+  for (const std::string &Arg : Args)
+    Argv.push_back(Arg.c_str());
+
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(&ClangInstance->getDiagnostics());
+#if LLVM_VERSION_MAJOR < 15
+  std::unique_ptr<CompilerInvocation> Invocation =
+    createInvocationFromCommandLine(Argv, Diags);
+#else
+  CreateInvocationOptions Opts;
+  Opts.Diags = Diags;
+  std::unique_ptr<CompilerInvocation> Invocation =
+    createInvocation(Argv, Opts);
+#endif
+  if (!Invocation || Invocation->getFrontendOpts().Inputs.empty()) {
+    ErrorMsg = "Cannot parse the compiler flags!";
+    return false;
+  }
+
+  ClangInstance->setInvocation(std::move(Invocation));
+  return true;
+}
+
+// A snapshot is keyed by the content of the source file and by everything
+// the compiler options are built from. The included files are only known
+// once the source file is parsed: a snapshot is saved with the list of its
+// included files, and their contents are a part of the snapshot file name.
+std::string TransformationManager::getSnapshotKey()
+{
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+    llvm::MemoryBuffer::getFile(SrcFileName);
+  if (!Buffer)
+    return "";
+
+  llvm::MD5 Hash;
+  auto AddToHash = [&Hash](StringRef Str) {
+    Hash.update(Str);
+    Hash.update(StringRef("\0", 1));
+  };
+  AddToHash(getClangFullVersion());
+  AddToHash(llvm::sys::path::extension(SrcFileName));
+  for (const std::string &Arg : CompilerArgs)
+    AddToHash(Arg);
+  if (SetCXXStandard)
+    AddToHash(CXXStandard);
+  const char *Envs[] = {"CVISE_TARGET_TRIPLE", "CVISE_INCLUDE_PATH",
+                        "CVISE_LIBCLC_INCLUDE_PATH"};
+  for (const char *Env : Envs) {
+    const char *Value = getenv(Env);
+    AddToHash(Value ? Value : "");
+  }
+  AddToHash((*Buffer)->getBuffer());
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  llvm::SmallString<256> Path(ASTCacheDir);
+  llvm::sys::path::append(Path, std::string(Result.digest().str()));
+  return std::string(Path.str());
+}
+
+std::string TransformationManager::getSnapshotFileName(
+    const std::vector<std::string> &IncludedFiles)
+{
+  llvm::MD5 Hash;
+  for (const std::string &File : IncludedFiles) {
+    Hash.update(File);
+    Hash.update(StringRef("\0", 1));
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(File);
+    // Tell a missing file from an empty one
+    Hash.update(StringRef(Buffer ? "\1" : "\0", 1));
+    if (Buffer)
+      Hash.update((*Buffer)->getBuffer());
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  return SnapshotKey + "-" + std::string(Result.digest().str()) + ".ast";
+}
+
+bool TransformationManager::loadSnapshot()
+{
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Includes =
+    llvm::MemoryBuffer::getFile(SnapshotKey + ".includes");
+  if (!Includes)
+    return false;
+  std::vector<std::string> IncludedFiles;
+  llvm::SmallVector<StringRef, 16> Lines;
+  (*Includes)->getBuffer().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  for (StringRef Line : Lines)
+    IncludedFiles.push_back(Line.str());
+
+  std::string SnapshotFileName = getSnapshotFileName(IncludedFiles);
+  if (!llvm::sys::fs::exists(SnapshotFileName))
+    return false;
+
+  // A snapshot which can't be loaded is simply parsed again
+  DiagnosticsEngine &Diag = ClangInstance->getDiagnostics();
+  Diag.setSuppressAllDiagnostics(true);
+  Snapshot = ASTUnit::LoadFromASTFile(
+    SnapshotFileName, ClangInstance->getPCHContainerReader(),
+    ASTUnit::LoadEverything, IntrusiveRefCntPtr<DiagnosticsEngine>(&Diag),
+    ClangInstance->getFileSystemOpts()
+#if LLVM_VERSION_MAJOR >= 17
+    , std::make_shared<HeaderSearchOptions>(
+        ClangInstance->getHeaderSearchOpts())
+#endif
+    );
+  if (!Snapshot)
+    return false;
+
+  // The snapshot is the most recently used one of the cache now
+  int FD;
+  if (!llvm::sys::fs::openFileForRead(SnapshotFileName, FD)) {
+    llvm::sys::TimePoint<> Now = llvm::sys::toTimePoint(std::time(nullptr));
+    llvm::sys::fs::setLastAccessAndModificationTime(FD, Now, Now);
+    llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+  }
+  return true;
+}
+
+// Write to a unique file renamed to Path, so that the clang_delta runs
+// sharing the cache never read a partial one
+static void writeCacheFile(const std::string &Path, StringRef Data)
+{
+  int FD;
+  llvm::SmallString<256> TmpPath;
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)) ||
+      llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write(Data.data(), Data.size());
+  }
+  if (llvm::sys::fs::rename(TmpPath, Path))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+void TransformationManager::saveSnapshot()
+{
+  // The instantiations can't be replayed in the order ParseAST passes them,
+  // so a translation unit with any of them is always parsed
+  InstantiationFinder Finder;
+  Finder.TraverseDecl(ClangInstance->getASTContext().getTranslationUnitDecl());
+  if (Finder.Found)
+    return;
+
+  llvm::SmallString<256> Buffer;
+  {
+    llvm::BitstreamWriter Stream(Buffer);
+    InMemoryModuleCache ModuleCache;
+    ASTWriter Writer(Stream, Buffer, ModuleCache, {});
+    Writer.WriteAST(ClangInstance->getSema(), std::string(), nullptr, "");
+  }
+
+  // The content of the source file is in the key already
+  std::vector<std::string> IncludedFiles;
+  std::string IncludesList;
+  for (const std::string &File : IncludedFilesCollector->getDependencies()) {
+    if (File == SrcFileName)
+      continue;
+    IncludedFiles.push_back(File);
+    IncludesList += File + "\n";
+  }
+  writeCacheFile(SnapshotKey + ".includes", IncludesList);
+  writeCacheFile(getSnapshotFileName(IncludedFiles), Buffer);
+  evictSnapshots();
+}
+
+// Remove the least recently used snapshots until the cache directory fits
+// into ASTCacheSize. The files of the snapshot just saved are kept, and so
+// are the unique files the other clang_delta runs are writing.
+void TransformationManager::evictSnapshots()
+{
+  struct CacheFile {
+    llvm::sys::TimePoint<> LastUsed;
+    uint64_t Size;
+    std::string Path;
+  };
+  std::vector<CacheFile> Files;
+  uint64_t TotalSize = 0;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator It(ASTCacheDir, EC), End;
+       !EC && It != End; It.increment(EC)) {
+    llvm::ErrorOr<llvm::sys::fs::basic_file_status> Status = It->status();
+    if (!Status || Status->type() != llvm::sys::fs::file_type::regular_file)
+      continue;
+    TotalSize += Status->getSize();
+    const std::string &Path = It->path();
+    StringRef Extension = llvm::sys::path::extension(Path);
+    if (Path.compare(0, SnapshotKey.size(), SnapshotKey) &&
+        (Extension == ".ast" || Extension == ".includes"))
+      Files.push_back({Status->getLastModificationTime(), Status->getSize(),
+                       Path});
+  }
+
+  std::sort(Files.begin(), Files.end(),
+            [](const CacheFile &A, const CacheFile &B) {
+              return A.LastUsed < B.LastUsed;
+            });
+  for (const CacheFile &File : Files) {
+    if (TotalSize <= ASTCacheSize)
+      break;
+    if (!llvm::sys::fs::remove(File.Path))
+      TotalSize -= File.Size;
+  }
+}
+
+// Pass the loaded translation unit to the transformation the way ParseAST
+// does: its top-level declaration groups, then the whole translation unit.
+// A group is made of the declarations which start at the same location,
+// e.g., "struct S {} s1, s2;". There are no template instantiations to pass,
+// see saveSnapshot, but all the redeclarations of a declaration are already
+// there.
+void TransformationManager::replaySnapshot()
+{
+  ASTContext &Ctx = ClangInstance->getASTContext();
+  ASTConsumer &Consumer = ClangInstance->getASTConsumer();
+  llvm::SmallVector<Decl *, 8> Group;
+  auto HandleGroup = [&]() {
+    if (Group.empty())
+      return;
+    Consumer.HandleTopLevelDecl(
+      DeclGroupRef::Create(Ctx, Group.data(), Group.size()));
+    Group.clear();
+  };
+
+  for (Decl *D : Ctx.getTranslationUnitDecl()->decls()) {
+    if (D->isImplicit())
+      continue;
+    if (!Group.empty() && Group.back()->getBeginLoc() != D->getBeginLoc())
+      HandleGroup();
+    Group.push_back(D);
+  }
+  HandleGroup();
+  Consumer.HandleTranslationUnit(Ctx);
+}
+
 bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
 {
   if (ClangInstance) {
@@ -98,19 +525,37 @@ bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
   
   ClangInstance->createDiagnostics();
 
+  InputKind IK = FrontendOptions::getInputKindForExtension(
+        StringRef(SrcFileName).rsplit('.').second);
+  if (!CompileCommandsFileName.empty() && !readCompileCommand(ErrorMsg))
+    return false;
+
+  bool HasCompilerArgs = !CompilerArgs.empty();
+  if (HasCompilerArgs) {
+#if LLVM_VERSION_MAJOR < 10
+    bool IsCXX = (IK.getLanguage() == InputKind::CXX);
+#else
+    bool IsCXX = (IK.getLanguage() == Language::CXX);
+#endif
+    if (!createInvocationFromCompilerArgs(IsCXX, ErrorMsg))
+      return false;
+    IK = ClangInstance->getFrontendOpts().Inputs[0].getKind();
+  }
+
   TargetOptions &TargetOpts = ClangInstance->getTargetOpts();
 #if LLVM_VERSION_MAJOR < 12
   PreprocessorOptions &PPOpts = ClangInstance->getPreprocessorOpts();
 #endif
-  if (const char *env = getenv("CVISE_TARGET_TRIPLE")) {
+  if (HasCompilerArgs) {
+    // The driver has set the target up
+  }
+  else if (const char *env = getenv("CVISE_TARGET_TRIPLE")) {
     TargetOpts.Triple = std::string(env);
   } else {
     TargetOpts.Triple = LLVM_DEFAULT_TARGET_TRIPLE;
   }
   llvm::Triple T(TargetOpts.Triple);
   CompilerInvocation &Invocation = ClangInstance->getInvocation();
-  InputKind IK = FrontendOptions::getInputKindForExtension(
-        StringRef(SrcFileName).rsplit('.').second);
   LangStandard::Kind LSTD = LangStandard::lang_unspecified;
   if (SetCXXStandard) {
     if (!CXXStandard.compare("c++98"))
@@ -142,8 +587,14 @@ bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
     }
   }
 
+#if LLVM_VERSION_MAJOR >= 12
+  vector<string> includes;
+#endif
+  if (HasCompilerArgs) {
+    // The driver has set the language options up
+  }
 #if LLVM_VERSION_MAJOR < 10
-  if (IK.getLanguage() == InputKind::C) {
+  else if (IK.getLanguage() == InputKind::C) {
     Invocation.setLangDefaults(ClangInstance->getLangOpts(), InputKind::C, T, PPOpts);
   }
   else if (IK.getLanguage() == InputKind::CXX) {
@@ -154,7 +605,7 @@ bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
   }
   else if(IK.getLanguage() == InputKind::OpenCL) {
 #elif LLVM_VERSION_MAJOR < 12
-  if (IK.getLanguage() == Language::C) {
+  else if (IK.getLanguage() == Language::C) {
     Invocation.setLangDefaults(ClangInstance->getLangOpts(), InputKind(Language::C), T, PPOpts);
   }
   else if (IK.getLanguage() == Language::CXX) {
@@ -165,8 +616,7 @@ bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
   }
   else if(IK.getLanguage() == Language::OpenCL) {
 #elif LLVM_VERSION_MAJOR < 15
-  vector<string> includes;
-  if (IK.getLanguage() == Language::C) {
+  else if (IK.getLanguage() == Language::C) {
     Invocation.setLangDefaults(ClangInstance->getLangOpts(), InputKind(Language::C), T, includes);
   }
   else if (IK.getLanguage() == Language::CXX) {
@@ -177,8 +627,7 @@ bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
   }
   else if(IK.getLanguage() == Language::OpenCL) {
 #else
-  vector<string> includes;
-  if (IK.getLanguage() == Language::C) {
+  else if (IK.getLanguage() == Language::C) {
     LangOptions::setLangDefaults(ClangInstance->getLangOpts(), Language::C, T, includes);
   }
   else if (IK.getLanguage() == Language::CXX) {
@@ -261,14 +710,41 @@ bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
     } while(next != npos);
   }
 
-  ClangInstance->createFileManager();
-  ClangInstance->createSourceManager(ClangInstance->getFileManager());
-  ClangInstance->createPreprocessor(TU_Complete);
+  // A snapshot is loaded without running the preprocessor
+  if (!ASTCacheDir.empty() &&
+      !CurrentTransformationImpl->usesPreprocessorCallbacks())
+    SnapshotKey = getSnapshotKey();
+
+  if (!SnapshotKey.empty() && loadSnapshot()) {
+    // Take the loaded translation unit over, like clang does for AST files
+    ClangInstance->setFileManager(&Snapshot->getFileManager());
+    ClangInstance->setSourceManager(&Snapshot->getSourceManager());
+    ClangInstance->setPreprocessor(Snapshot->getPreprocessorPtr());
+  }
+  else {
+    ClangInstance->createFileManager();
+    ClangInstance->createSourceManager(ClangInstance->getFileManager());
+    // Embed the source files into the snapshot, so that it can be loaded
+    // for a copy of the source file anywhere, and list the included files
+    if (!SnapshotKey.empty()) {
+      ClangInstance->getSourceManager().setAllFilesAreTransient(true);
+      IncludedFilesCollector = std::make_shared<IncludedFilesCollectorImpl>();
+      ClangInstance->addDependencyCollector(IncludedFilesCollector);
+    }
+    if (UseSrcBuffer)
+      ClangInstance->getPreprocessorOpts().addRemappedFile(
+        SrcFileName,
+        llvm::MemoryBuffer::getMemBufferCopy(SrcBuffer, SrcFileName).release());
+    ClangInstance->createPreprocessor(TU_Complete);
+  }
 
   DiagnosticConsumer &DgClient = ClangInstance->getDiagnosticClient();
   DgClient.BeginSourceFile(ClangInstance->getLangOpts(),
                            &ClangInstance->getPreprocessor());
-  ClangInstance->createASTContext();
+  if (Snapshot)
+    ClangInstance->setASTContext(&Snapshot->getASTContext());
+  else
+    ClangInstance->createASTContext();
 
   // It's not elegant to initialize these two here... Ideally, we 
   // would put them in doTransformation, but we need these two
@@ -288,7 +764,8 @@ bool TransformationManager::initializeCompilerInstance(std::string &ErrorMsg)
   PP.getBuiltinInfo().initializeBuiltins(PP.getIdentifierTable(),
                                          PP.getLangOpts());
 
-  if (!ClangInstance->InitializeSourceManager(FrontendInputFile(SrcFileName, IK))) {
+  if (!Snapshot &&
+      !ClangInstance->InitializeSourceManager(FrontendInputFile(SrcFileName, IK))) {
     ErrorMsg = "Cannot open source file!";
     return false;
   }
@@ -333,10 +810,107 @@ void TransformationManager::closeOutStream(llvm::raw_ostream *OutStream)
 }
 
 bool TransformationManager::doTransformation(std::string &ErrorMsg, int &ErrorCode)
+{
+  std::string Output;
+  if (!transform(Output, ErrorMsg, ErrorCode))
+    return false;
+
+  if (!QueryInstanceOnly) {
+    llvm::raw_ostream *OutStream = getOutStream();
+    *OutStream << Output;
+    OutStream->flush();
+    closeOutStream(OutStream);
+  }
+  return true;
+}
+
+// Apply the transformations of the pipeline one after another in this
+// process. Each step parses the output of the previous one from memory. The
+// output of every step which changes the source is written to
+// <output>.<step number>, so that each step can be tested on its own. A step
+// without a valid instance leaves the source unchanged. Every step is
+// announced on stderr before it is run, so that the step which brings down
+// the whole process can be told. A step which crashes or fails for any other
+// reason than a missing instance is reported as well and also leaves the
+// source unchanged; the outputs of the other steps are still written, but
+// the pipeline exits with ErrorFailedPipelineSteps.
+bool TransformationManager::doPipeline(std::string &ErrorMsg, int &ErrorCode)
+{
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+    llvm::MemoryBuffer::getFile(SrcFileName);
+  if (!Buffer) {
+    ErrorMsg = "Cannot open source file!";
+    return false;
+  }
+  SrcBuffer = std::string((*Buffer)->getBuffer());
+  UseSrcBuffer = true;
+  // The snapshots are keyed by the content of the source file on disk
+  ASTCacheDir.clear();
+
+  bool Changed = false;
+  std::vector<size_t> FailedSteps;
+  for (size_t I = 0; I < PipelineTransNames.size(); ++I) {
+    llvm::errs() << "Pipeline step " << I + 1 << ": "
+                 << PipelineTransNames[I] << "\n";
+    if (ClangInstance) {
+      // The previous transformation is freed with its CompilerInstance
+      TransformationsMap.erase(CurrentTransName);
+      delete ClangInstance;
+      ClangInstance = NULL;
+    }
+    setTransformation(PipelineTransNames[I]);
+    if (!initializeCompilerInstance(ErrorMsg))
+      return false;
+    // The flags of the compilation database have been added to CompilerArgs
+    CompileCommandsFileName.clear();
+
+    std::string Output, StepErrorMsg;
+    int StepErrorCode = -1;
+    if (!transform(Output, StepErrorMsg, StepErrorCode)) {
+      if (StepErrorCode != ErrorInvalidCounter) {
+        llvm::errs() << "Failed pipeline step " << I + 1 << ": "
+                     << StepErrorMsg << "\n";
+        FailedSteps.push_back(I + 1);
+      }
+      continue;
+    }
+    if (Output == SrcBuffer)
+      continue;
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OutStream(OutputFileName + "." + std::to_string(I + 1),
+                                   EC);
+    if (EC) {
+      ErrorMsg = "Cannot open output file!";
+      return false;
+    }
+    OutStream << Output;
+    SrcBuffer = Output;
+    Changed = true;
+  }
+
+  if (!FailedSteps.empty()) {
+    ErrorMsg = "Failed pipeline steps:";
+    for (size_t Step : FailedSteps)
+      ErrorMsg += " " + std::to_string(Step);
+    ErrorCode = ErrorFailedPipelineSteps;
+    return false;
+  }
+  if (!Changed) {
+    ErrorMsg = "No transformation of the pipeline has a valid instance!";
+    ErrorCode = ErrorInvalidCounter;
+    return false;
+  }
+  return true;
+}
+
+bool TransformationManager::transform(std::string &Output,
+                                      std::string &ErrorMsg, int &ErrorCode)
 {
   ErrorMsg = "";
 
-  ClangInstance->createSema(TU_Complete, 0);
+  if (!Snapshot)
+    ClangInstance->createSema(TU_Complete, 0);
   DiagnosticsEngine &Diag = ClangInstance->getDiagnostics();
   Diag.setSuppressAllDiagnostics(true);
   Diag.setIgnoreAllWarnings(true);
@@ -345,6 +919,8 @@ bool TransformationManager::doTransformation(std::string &ErrorMsg, int &ErrorCo
   CurrentTransformationImpl->setQueryInstanceFlag(QueryInstanceOnly);
   CurrentTransformationImpl->setTransformationCounter(TransformationCounter);
   CurrentTransformationImpl->setPreprocessor(&ClangInstance->getPreprocessor());
+  for (const std::pair<unsigned, unsigned> &Region : Regions)
+    CurrentTransformationImpl->addRegion(Region.first, Region.second);
   if (ToCounter > 0) {
     if (CurrentTransformationImpl->isMultipleRewritesEnabled()) {
       CurrentTransformationImpl->setToCounter(ToCounter);
@@ -357,32 +933,77 @@ bool TransformationManager::doTransformation(std::string &ErrorMsg, int &ErrorCo
     }
   }
 
-  ParseAST(ClangInstance->getSema());
+  // Let the transformations recover from a crash in one instance. A crash
+  // outside of the instances, e.g., while parsing or collecting them, fails
+  // the whole transformation with its own exit code.
+  llvm::CrashRecoveryContext::Enable();
+  llvm::CrashRecoveryContext CRC;
+  bool Completed = CRC.RunSafely([this]() {
+    if (Snapshot)
+      replaySnapshot();
+    else
+      ParseAST(ClangInstance->getSema());
+  });
+  if (!Completed) {
+    llvm::errs() << "Crash signature: crash in " << CurrentTransName
+                 << " outside of the instances";
+#if LLVM_VERSION_MAJOR >= 11
+    if (CRC.RetCode > 128)
+      llvm::errs() << ": " << strsignal(CRC.RetCode - 128);
+#endif
+    llvm::errs() << "\n";
+    // The compiler state is unknown after the crash, so the compiler
+    // instance and the transformation it owns are leaked rather than freed
+    TransformationsMap.erase(CurrentTransName);
+    ClangInstance = NULL;
+    ErrorMsg = "The transformation crashed!";
+    ErrorCode = ErrorCrashedTransformation;
+    return false;
+  }
 
   ClangInstance->getDiagnosticClient().EndSourceFile();
 
+  if (!SnapshotKey.empty() && !Snapshot)
+    saveSnapshot();
+
+  const std::vector<int> &Crashed =
+    CurrentTransformationImpl->getCrashedInstances();
+  if (!Crashed.empty()) {
+    llvm::errs() << "Crashed transformation instances:";
+    for (int I : Crashed)
+      llvm::errs() << " " << I;
+    llvm::errs() << "\n";
+    llvm::errs() << "Crash signature: "
+                 << CurrentTransformationImpl->getCrashSignature() << "\n";
+
+    int NumInstances =
+      (ToCounter > 0 ? ToCounter : TransformationCounter) -
+      TransformationCounter + 1;
+    if (static_cast<int>(Crashed.size()) >= NumInstances) {
+      ErrorMsg = "All the transformation instances crashed!";
+      ErrorCode = ErrorCrashedInstances;
+      return false;
+    }
+  }
+
   if (QueryInstanceOnly) {
     return true;
   }
 
-  llvm::raw_ostream *OutStream = getOutStream();
-  bool RV;
+  llvm::raw_string_ostream OutStream(Output);
   if (CurrentTransformationImpl->transSuccess()) {
-    CurrentTransformationImpl->outputTransformedSource(*OutStream);
-    RV = true;
+    CurrentTransformationImpl->outputTransformedSource(OutStream);
+    return true;
   }
   else if (CurrentTransformationImpl->transInternalError()) {
-    CurrentTransformationImpl->outputOriginalSource(*OutStream);
-    RV = true;
-  }
-  else {
-    CurrentTransformationImpl->getTransErrorMsg(ErrorMsg);
-    if (CurrentTransformationImpl->isInvalidCounterError())
-      ErrorCode = ErrorInvalidCounter;
-    RV = false;
+    CurrentTransformationImpl->outputOriginalSource(OutStream);
+    return true;
   }
-  closeOutStream(OutStream);
-  return RV;
+
+  CurrentTransformationImpl->getTransErrorMsg(ErrorMsg);
+  if (CurrentTransformationImpl->isInvalidCounterError())
+    ErrorCode = ErrorInvalidCounter;
+  return false;
 }
 
 bool TransformationManager::verify(std::string &ErrorMsg, int &ErrorCode)
@@ -392,6 +1013,22 @@ bool TransformationManager::verify(std::string &ErrorMsg, int &ErrorCode)
     return false;
   }
 
+  if (isPipeline()) {
+    if (QueryInstanceOnly || (ToCounter > 0)) {
+      ErrorMsg = "A pipeline applies one instance of each transformation!";
+      return false;
+    }
+    if (OutputFileName.empty()) {
+      ErrorMsg = "A pipeline needs an output file name!";
+      return false;
+    }
+    // The offsets of the regions are only valid for the first step
+    if (!Regions.empty()) {
+      ErrorMsg = "A pipeline cannot be restricted to regions!";
+      return false;
+    }
+  }
+
   if (CurrentTransformationImpl->skipCounter())
     return true;
 
@@ -410,6 +1047,26 @@ bool TransformationManager::verify(std::string &ErrorMsg, int &ErrorCode)
   return true;
 }
 
+// Set up a comma-separated list of distinct transformations, each of which
+// is applied once by doPipeline
+int TransformationManager::setPipeline(const std::string &TransNames)
+{
+  std::vector<std::string> Names;
+  std::stringstream TmpSS(TransNames);
+  std::string Name;
+  while (std::getline(TmpSS, Name, ',')) {
+    if ((TransformationsMap.find(Name) == TransformationsMap.end()) ||
+        (std::find(Names.begin(), Names.end(), Name) != Names.end()))
+      return -1;
+    Names.push_back(Name);
+  }
+  if (Names.empty())
+    return -1;
+
+  PipelineTransNames = Names;
+  return setTransformation(Names.front());
+}
+
 void TransformationManager::registerTransformation(
        const char *TransName, 
        Transformation *TransImpl)
@@ -472,6 +1129,8 @@ TransformationManager::TransformationManager()
     SrcFileName(""),
     OutputFileName(""),
     CurrentTransName(""),
+    SrcBuffer(""),
+    UseSrcBuffer(false),
     ClangInstance(NULL),
     QueryInstanceOnly(false),
     DoReplacement(false),
@@ -482,6 +1141,10 @@ TransformationManager::TransformationManager()
     ReferenceValue(""),
     SetCXXStandard(false),
     CXXStandard(""),
+    CompileCommandsFileName(""),
+    ASTCacheDir(""),
+    ASTCacheSize(1024ULL * 1024 * 1024),
+    SnapshotKey(""),
     WarnOnCounterOutOfBounds(false),
     ReportInstancesCount(false)
 {
@@ -13,13 +13,18 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
+#include <utility>
 #include <cassert>
 
 #include "llvm/Support/raw_ostream.h"
 
 class Transformation;
 namespace clang {
+  class ASTUnit;
   class CompilerInstance;
+  class DependencyCollector;
   class Preprocessor;
 }
 
@@ -44,8 +49,16 @@ public:
 
   static int ErrorInvalidCounter;
 
+  static int ErrorCrashedInstances;
+
+  static int ErrorCrashedTransformation;
+
+  static int ErrorFailedPipelineSteps;
+
   bool doTransformation(std::string &ErrorMsg, int &ErrorCode);
 
+  bool doPipeline(std::string &ErrorMsg, int &ErrorCode);
+
   bool verify(std::string &ErrorMsg, int &ErrorCode);
 
   int setTransformation(const std::string &Trans) {
@@ -56,6 +69,12 @@ public:
     return 0;
   }
 
+  int setPipeline(const std::string &TransNames);
+
+  bool isPipeline() {
+    return !PipelineTransNames.empty();
+  }
+
   void setTransformationCounter(int Counter) {
     assert((Counter > 0) && "Bad Counter value!");
     TransformationCounter = Counter;
@@ -103,6 +122,26 @@ public:
     SetCXXStandard = true;
   }
 
+  void setCompileCommandsFileName(const std::string &FileName) {
+    CompileCommandsFileName = FileName;
+  }
+
+  void addCompilerArg(const std::string &Arg) {
+    CompilerArgs.push_back(Arg);
+  }
+
+  void setASTCacheDir(const std::string &Dir) {
+    ASTCacheDir = Dir;
+  }
+
+  void setASTCacheSize(unsigned long long Size) {
+    ASTCacheSize = Size;
+  }
+
+  void addRegion(unsigned Offset, unsigned Length) {
+    Regions.push_back(std::make_pair(Offset, Length));
+  }
+
   void setReportInstancesCount(bool Flag) {
     ReportInstancesCount = Flag;
   }
@@ -135,6 +174,25 @@ private:
 
   void closeOutStream(llvm::raw_ostream *OutStream);
 
+  bool transform(std::string &Output, std::string &ErrorMsg, int &ErrorCode);
+
+  bool readCompileCommand(std::string &ErrorMsg);
+
+  bool createInvocationFromCompilerArgs(bool IsCXX, std::string &ErrorMsg);
+
+  std::string getSnapshotKey();
+
+  std::string getSnapshotFileName(
+    const std::vector<std::string> &IncludedFiles);
+
+  bool loadSnapshot();
+
+  void saveSnapshot();
+
+  void evictSnapshots();
+
+  void replaySnapshot();
+
   static TransformationManager *Instance;
 
   static std::map<std::string, Transformation *> *TransformationsMapPtr;
@@ -153,6 +211,15 @@ private:
 
   std::string CurrentTransName;
 
+  // The transformations applied one after another by doPipeline
+  std::vector<std::string> PipelineTransNames;
+
+  // The content the source file is parsed with instead of the one on disk,
+  // i.e., the output of the previous step of a pipeline
+  std::string SrcBuffer;
+
+  bool UseSrcBuffer;
+
   clang::CompilerInstance *ClangInstance;
 
   bool QueryInstanceOnly;
@@ -173,6 +240,30 @@ private:
 
   std::string CXXStandard;
 
+  std::string CompileCommandsFileName;
+
+  // Clang driver flags from the compilation database and the command line
+  std::vector<std::string> CompilerArgs;
+
+  // (offset, length) byte ranges of the source file which the instances
+  // are limited to
+  std::vector<std::pair<unsigned, unsigned> > Regions;
+
+  // Directory of the serialized ASTs of the parsed source files
+  std::string ASTCacheDir;
+
+  // Size in bytes the AST cache directory is trimmed to after each snapshot
+  unsigned long long ASTCacheSize;
+
+  // Path of the snapshots of the source file without their suffix
+  std::string SnapshotKey;
+
+  // The files included by the source file while it is parsed
+  std::shared_ptr<clang::DependencyCollector> IncludedFilesCollector;
+
+  // The serialized AST of the source file, if it has been parsed before
+  std::unique_ptr<clang::ASTUnit> Snapshot;
+
   bool WarnOnCounterOutOfBounds;
 
   bool ReportInstancesCount;
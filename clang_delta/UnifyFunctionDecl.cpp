@@ -41,7 +41,7 @@ bool UnifyFunctionDecl::HandleTopLevelDecl(DeclGroupRef D)
     if (!FD)
       return true;    
 
-    if (isInIncludedFile(FD))
+    if (isInIncludedFile(FD) || isOutsideRegions(FD))
       return true;
 
     if (!FD->hasBody())
@@ -82,8 +82,12 @@ void UnifyFunctionDecl::HandleTranslationUnit(ASTContext &Ctx)
 
 void UnifyFunctionDecl::doAnalysis(void)
 {
-  for (FunctionDeclSet::iterator I = VisitedFunctionDecls.begin(),
-       E = VisitedFunctionDecls.end(); I != E; ++I) {
+  FunctionDeclVector FunctionDecls(VisitedFunctionDecls.begin(),
+                                   VisitedFunctionDecls.end());
+  sortBySourceOrder(FunctionDecls);
+
+  for (FunctionDeclVector::iterator I = FunctionDecls.begin(),
+       E = FunctionDecls.end(); I != E; ++I) {
 
     const FunctionDecl *FDDef = NULL; 
     const FunctionDecl *FDDecl = NULL;
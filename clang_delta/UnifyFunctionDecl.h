@@ -38,6 +38,9 @@ private:
   typedef llvm::SmallPtrSet<const clang::FunctionDecl *, 10>
             FunctionDeclSet;
 
+  typedef llvm::SmallVector<const clang::FunctionDecl *, 10>
+            FunctionDeclVector;
+
   virtual void Initialize(clang::ASTContext &context);
 
   virtual bool HandleTopLevelDecl(clang::DeclGroupRef D);
@@ -87,7 +87,8 @@ bool UnionToStructCollectionVisitor::VisitFieldDecl(FieldDecl *FD)
 
 bool UnionToStructCollectionVisitor::VisitRecordDecl(RecordDecl *RD)
 {
-  if (RD->isUnion() && !ConsumerInstance->isInIncludedFile(RD))
+  if (RD->isUnion() && !ConsumerInstance->isInIncludedFile(RD) &&
+      !ConsumerInstance->isOutsideRegions(RD))
     ConsumerInstance->addOneRecord(RD);
 
   return true;
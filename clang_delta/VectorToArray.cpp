@@ -59,7 +59,7 @@ public:
   bool VisitNamedDecl(NamedDecl *D) { return true; }
 
   bool VisitClassTemplateDecl(ClassTemplateDecl *D) {
-    if (Consumer->isInIncludedFile(D))
+    if (Consumer->isInIncludedFile(D) || Consumer->isOutsideRegions(D))
       return true;
     auto *NS = dyn_cast<NamespaceDecl>(D->getDeclContext());
     if (!NS)
@@ -78,7 +78,7 @@ public:
   }
 
   bool VisitVarDecl(VarDecl *D) {
-    if (Consumer->isInIncludedFile(D))
+    if (Consumer->isInIncludedFile(D) || Consumer->isOutsideRegions(D))
       return true;
     const Type *Ty = D->getType().getTypePtr();
     if (!Ty)
@@ -120,7 +120,7 @@ public:
     if (VD != Consumer->TheVarDecl)
       return true;
 
-    Rewriter &TheRewriter = Consumer->TheRewriter;
+    EditRewriter &TheRewriter = Consumer->TheRewriter;
     const SourceManager &SM = TheRewriter.getSourceMgr();
 
     SourceLocation NameLoc = VD->getLocation();
@@ -0,0 +1,17 @@
+struct A {
+  int a;
+  virtual int f() { return a; }
+};
+struct B : A {
+  int b;
+  B() : b(1) {}
+  int f() { return b; }
+};
+struct C : public B {
+  int c;
+  C() : B(), c(2) {}
+};
+int g(C *p) {
+  A *q = p;
+  return q->f() + static_cast<B *>(p)->b;
+}
@@ -0,0 +1,19 @@
+namespace ns {
+struct S { int x; };
+}
+typedef ns::S Rec;
+typedef unsigned int UInt;
+typedef UInt *UIntPtr;
+struct A {
+  typedef int Int;
+  Int f();
+};
+A::Int A::f() { return 0; }
+typedef int *IntPtr;
+void g(const IntPtr p);
+typedef char *CharPtr;
+CharPtr c1, c2;
+UInt h(UIntPtr p, Rec r) {
+  Rec *q = &r;
+  return *p + q->x + UInt(1);
+}
@@ -0,0 +1,6 @@
+int abcdef;
+
+void foo(int *p)
+{
+  *p = abcdef;
+}
@@ -0,0 +1,10 @@
+namespace A {
+  int x;
+  namespace B {
+    int x;
+    int f(void) { return x; }
+  }
+  int g(void) { return x + B::f(); }
+}
+int x;
+int h(void) { return A::x + A::B::x + x; }
@@ -0,0 +1,4 @@
+#ifdef RENAME
+int foo() { return 0; }
+int bar() { return foo(); }
+#endif
@@ -0,0 +1,2 @@
+int foo(void) { return 0; }
+int bar(void) { return foo(); }
@@ -0,0 +1,9 @@
+struct S {
+  int a;
+  int b;
+};
+int s_a;
+int foo(void) {
+  struct S s = {1, 2};
+  return s.a + s.b + s_a;
+}
@@ -0,0 +1,18 @@
+struct S {
+  int a;
+  char *p;
+};
+struct T {
+  int x[2];
+};
+struct S g = {1, 0};
+struct S h;
+void f(struct S *);
+int foo(void) {
+  struct S s = {.p = 0};
+  struct S t = {2, 0};
+  struct T u;
+  s.a = g.a + 1;
+  f(&t);
+  return s.a + (h.p != 0) + u.x[0];
+}
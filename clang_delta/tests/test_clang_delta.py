@@ -1,6 +1,7 @@
 import os
 import re
 import subprocess
+import tempfile
 import unittest
 
 
@@ -124,6 +125,17 @@ class TestClangDelta(unittest.TestCase):
             '--transformation=copy-propagation --counter=2',
         )
 
+    def test_desugar_typedef(self):
+        self.check_query_instances(
+            'desugar-typedef/test1.cc',
+            '--query-instances=desugar-typedef',
+            'Available transformation instances: 3',
+        )
+        self.check_clang_delta(
+            'desugar-typedef/test1.cc',
+            '--transformation=desugar-typedef --counter=1 --to-counter=3',
+        )
+
     def test_empty_struct_to_int_empty_struct(self):
         self.check_clang_delta(
             'empty-struct-to-int/empty-struct.cpp',
@@ -282,6 +294,32 @@ class TestClangDelta(unittest.TestCase):
     def test_param_to_global_macro(self):
         self.check_clang_delta('param-to-global/macro.c', '--transformation=param-to-global --counter=1')
 
+    def test_pipeline_test1(self):
+        current = os.path.dirname(__file__)
+        binary = os.path.join(current, '../clang_delta')
+        with tempfile.TemporaryDirectory() as tmp:
+            output = os.path.join(tmp, 'step')
+            cmd = f'{binary} {os.path.join(current, "pipeline/test1.c")} '
+            cmd += f'--pipeline=rename-fun,rename-class,rename-var --counter=1 --output={output}'
+            proc = subprocess.run(cmd, shell=True, check=True, encoding='utf8', stderr=subprocess.PIPE)
+            assert proc.stderr.splitlines() == [
+                'Pipeline step 1: rename-fun',
+                'Pipeline step 2: rename-class',
+                'Pipeline step 3: rename-var',
+            ]
+            # rename-class has nothing to do in C
+            assert sorted(os.listdir(tmp)) == ['step.1', 'step.3']
+            for step in (1, 3):
+                with open(f'{output}.{step}') as f, open(os.path.join(current, f'pipeline/test1.output{step}')) as e:
+                    assert f.read() == e.read()
+
+    def test_pipeline_region(self):
+        self.check_error_message(
+            'pipeline/test1.c',
+            '--pipeline=rename-fun,rename-var --counter=1 --output=step --region=0:10',
+            'Error: A pipeline cannot be restricted to regions!',
+        )
+
     def test_reduce_array_dim_non_type_temp_arg(self):
         self.check_clang_delta(
             'reduce-array-dim/non-type-temp-arg.cpp',
@@ -294,6 +332,75 @@ class TestClangDelta(unittest.TestCase):
             '--transformation=reduce-pointer-level --counter=1',
         )
 
+    def test_reduce_pointer_level_source_order(self):
+        # more declarations than SmallPtrSet keeps in insertion order; every
+        # run gets a different heap layout
+        for _ in range(5):
+            self.check_clang_delta(
+                'reduce-pointer-level/source-order.c',
+                '--transformation=reduce-pointer-level --counter=1',
+            )
+            self.check_clang_delta(
+                'reduce-pointer-level/source-order.c',
+                '--transformation=reduce-pointer-level --counter=24',
+                'reduce-pointer-level/source-order.output2',
+            )
+
+    def test_reduce_pointer_level_ast_cache(self):
+        with tempfile.TemporaryDirectory() as cache:
+            # the first run saves the snapshot, the second one loads it
+            for _ in range(2):
+                self.check_clang_delta(
+                    'reduce-pointer-level/source-order.c',
+                    f'--transformation=reduce-pointer-level --counter=24 --ast-cache={cache}',
+                    'reduce-pointer-level/source-order.output2',
+                )
+            # the snapshot and the list of its included files
+            assert len(os.listdir(cache)) == 2
+
+    def test_reduce_pointer_level_ast_cache_size(self):
+        with tempfile.TemporaryDirectory() as tmp, tempfile.TemporaryDirectory() as cache:
+            source = os.path.join(tmp, 'main.c')
+            for n in (1, 2):
+                with open(source, 'w') as f:
+                    f.write(''.join(f'int *p{i};\n' for i in range(n)))
+                self.check_query_instances(
+                    source,
+                    f'--query-instances=reduce-pointer-level --ast-cache={cache} --ast-cache-size=0',
+                    f'Available transformation instances: {n}',
+                )
+                # only the snapshot of the last content is kept
+                assert len(os.listdir(cache)) == 2
+
+    def test_reduce_pointer_level_ast_cache_header(self):
+        with tempfile.TemporaryDirectory() as tmp, tempfile.TemporaryDirectory() as cache:
+            source = os.path.join(tmp, 'main.c')
+            header = os.path.join(tmp, 'n.h')
+            with open(source, 'w') as f:
+                f.write('#include "n.h"\nint *p1;\n#if N > 1\nint *p2;\n#endif\n')
+            for n in (1, 2):
+                # the source file is the same, the snapshot of the first run must not be used
+                with open(header, 'w') as f:
+                    f.write(f'#define N {n}\n')
+                self.check_query_instances(
+                    source,
+                    f'--query-instances=reduce-pointer-level --ast-cache={cache}',
+                    f'Available transformation instances: {n}',
+                )
+
+    def test_reduce_pointer_level_region(self):
+        # the lines of p3 and p4
+        self.check_query_instances(
+            'reduce-pointer-level/source-order.c',
+            '--query-instances=reduce-pointer-level --region=18:18',
+            'Available transformation instances: 2',
+        )
+        self.check_clang_delta(
+            'reduce-pointer-level/source-order.c',
+            '--transformation=reduce-pointer-level --counter=1 --region=18:18',
+            'reduce-pointer-level/source-order.output3',
+        )
+
     def test_remove_enum_member_value_builtin_macro(self):
         self.check_clang_delta(
             'remove-enum-member-value/builtin_macro.c',
@@ -306,6 +413,17 @@ class TestClangDelta(unittest.TestCase):
             '--transformation=remove-unused-enum-member --counter=4 --to-counter=9',
         )
 
+    def test_flatten_namespaces(self):
+        self.check_query_instances(
+            'remove-namespace/flatten.cpp',
+            '--query-instances=flatten-namespaces',
+            'Available transformation instances: 1',
+        )
+        self.check_clang_delta(
+            'remove-namespace/flatten.cpp',
+            '--transformation=flatten-namespaces --counter=1',
+        )
+
     def test_remove_namespace_macro(self):
         self.check_clang_delta(
             'remove-namespace/macro.cpp',
@@ -878,6 +996,19 @@ class TestClangDelta(unittest.TestCase):
     def test_rename_fun_overloaded(self):
         self.check_clang_delta('rename-fun/overloaded.cc', '--transformation=rename-fun --counter=1')
 
+    def test_rename_fun_compiler_flags(self):
+        self.check_clang_delta('rename-fun/flags.c', '--transformation=rename-fun --counter=1 -- -DRENAME')
+
+    def test_rename_fun_compile_commands(self):
+        compile_commands = os.path.join(os.path.dirname(__file__), 'rename-fun')
+        self.check_clang_delta(
+            'rename-fun/flags.c', f'--transformation=rename-fun --counter=1 --compile-commands={compile_commands}'
+        )
+
+    def test_rename_fun_region(self):
+        # only foo is in the region, its call in bar is renamed as well
+        self.check_clang_delta('rename-fun/region.c', '--transformation=rename-fun --counter=1 --region=0:28')
+
     def test_rename_fun_test1(self):
         self.check_clang_delta('rename-fun/test1.c', '--transformation=rename-fun --counter=1')
 
@@ -978,6 +1109,21 @@ class TestClangDelta(unittest.TestCase):
     def test_return_void_test9(self):
         self.check_clang_delta('return-void/test9.c', '--transformation=return-void --counter=1')
 
+    def test_scalarize_aggregate(self):
+        self.check_query_instances(
+            'scalarize-aggregate/test1.c',
+            '--query-instances=scalarize-aggregate',
+            'Available transformation instances: 3',
+        )
+        self.check_clang_delta(
+            'scalarize-aggregate/test1.c',
+            '--transformation=scalarize-aggregate --counter=1 --to-counter=3',
+        )
+
+    def test_scalarize_aggregate_conflict(self):
+        # the global s_a keeps its name
+        self.check_clang_delta('scalarize-aggregate/conflict.c', '--transformation=scalarize-aggregate --counter=1')
+
     def test_simplify_callexpr_macro(self):
         self.check_clang_delta(
             'simplify-callexpr/macro.c',
@@ -1009,6 +1155,23 @@ class TestClangDelta(unittest.TestCase):
             'Available transformation instances: 0',
         )
 
+    def test_unify_function_decl_ast_cache(self):
+        current = os.path.dirname(__file__)
+        binary = os.path.join(current, '../clang_delta')
+        testcase = os.path.join(current, 'unify-function-decl/template.cc')
+        expected = subprocess.check_output(
+            f'{binary} {testcase} --query-instances=unify-function-decl', shell=True, encoding='utf8'
+        )
+        with tempfile.TemporaryDirectory() as cache:
+            # the instantiations are passed to the transformation only when the test case is parsed
+            for _ in range(2):
+                self.check_query_instances(
+                    'unify-function-decl/template.cc',
+                    f'--query-instances=unify-function-decl --ast-cache={cache}',
+                    expected.strip(),
+                )
+            assert os.listdir(cache) == []
+
     def test_union_to_struct_union1(self):
         self.check_clang_delta('union-to-struct/union1.c', '--transformation=union-to-struct --counter=1')
 
@@ -1052,6 +1215,17 @@ class TestClangDelta(unittest.TestCase):
             '--transformation=class-template-to-class --counter=1',
         )
 
+    def test_collapse_class_hierarchy(self):
+        self.check_query_instances(
+            'collapse-class-hierarchy/test1.cc',
+            '--query-instances=collapse-class-hierarchy',
+            'Available transformation instances: 2',
+        )
+        self.check_clang_delta(
+            'collapse-class-hierarchy/test1.cc',
+            '--transformation=collapse-class-hierarchy --counter=2',
+        )
+
     def test_replace_simple_typedef_test1(self):
         self.check_clang_delta(
             'replace-simple-typedef/test1.cc',
@@ -0,0 +1,4 @@
+template <typename T> T f(T);
+template <typename T> T f(T x) { return x; }
+int g(int);
+int g(int x) { return f(x) + f(1L); }
@@ -25,6 +25,11 @@ extern char *yytext;
  */
 extern int count;
 
+/*
+ * Offset in the input of the first byte of the token being processed.
+ */
+extern long token_offset;
+
 enum tok_kind {
   TOK_KEYWORD = 999,
   TOK_OP,
@@ -38,6 +43,17 @@ enum tok_kind {
 };
 
 void process_token(enum tok_kind);
+void process_token_text(const char *text, enum tok_kind kind);
+
+/*
+ * Record a comment at [start, end) of the input, comments are not tokens.
+ */
+void process_comment(long start, long end);
+
+/*
+ * Lex C++ instead of C, must be called before yylex().
+ */
+void set_cxx_mode(void);
 
 #define OK 51
 #define STOP 71
@@ -32,6 +32,8 @@ struct tok_t {
   char *str;
   enum tok_kind kind;
   int id;
+  // offset of the token in the input file
+  long offset;
 };
 
 static struct tok_t *tok_list;
@@ -39,7 +41,7 @@ static int toks;
 static int max_toks;
 static const int initial_length = 1;
 
-static int add_tok(char *str, enum tok_kind kind) {
+static int add_tok(const char *str, enum tok_kind kind) {
   assert(str);
   if (toks >= max_toks) {
     max_toks *= 2;
@@ -51,21 +53,67 @@ static int add_tok(char *str, enum tok_kind kind) {
   assert(tok_list[toks].str);
   tok_list[toks].kind = kind;
   tok_list[toks].id = -1;
+  tok_list[toks].offset = token_offset;
   toks++;
   return toks - 1;
 }
 
-void process_token(enum tok_kind kind) {
-  add_tok(yytext, kind);
+void process_token_text(const char *text, enum tok_kind kind) {
+  add_tok(text, kind);
   count++;
 }
 
+void process_token(enum tok_kind kind) {
+  process_token_text(yytext, kind);
+}
+
+struct comment_t {
+  long start;
+  long end;
+};
+
+static struct comment_t *comment_list;
+static int comments;
+static int max_comments;
+
+void process_comment(long start, long end) {
+  if (comments >= max_comments) {
+    max_comments = max_comments ? 2 * max_comments : 16;
+    comment_list = (struct comment_t *)realloc(
+        comment_list, max_comments * sizeof(struct comment_t));
+    assert(comment_list);
+  }
+  comment_list[comments].start = start;
+  comment_list[comments].end = end;
+  comments++;
+}
+
+static const char *cxx_extensions[] = {
+  ".C", ".H", ".c++", ".cc", ".cp", ".cpp", ".cppm", ".cxx", ".h++",
+  ".hh", ".hpp", ".hxx", ".ii", ".inl", ".ipp", ".ixx", ".tcc", ".tpp",
+};
+
+static int is_cxx_file(const char *path) {
+  const char *ext = strrchr(path, '.');
+  if (!ext || strpbrk(ext, "/\\"))
+    return 0;
+  unsigned int i;
+  for (i = 0; i < sizeof(cxx_extensions) / sizeof(cxx_extensions[0]); i++) {
+    if (strcmp(ext, cxx_extensions[i]) == 0)
+      return 1;
+  }
+  return 0;
+}
+
 enum mode_t {
   MODE_RENAME = 1111,
   MODE_PRINT,
   MODE_DELETE_STRING,
   MODE_RM_TOKS,
+  MODE_LIST_TOKENS,
+  MODE_LIST_COMMENTS,
   MODE_RM_TOK_PATTERN,
+  MODE_LIST_RM_TOK_PATTERN,
   MODE_SHORTEN_STRING,
   MODE_X_STRING,
   MODE_DEFINE,
@@ -301,6 +349,27 @@ static void rm_toks(int idx) {
   }
 }
 
+// print the input file offsets of the tokens that rm-toks counts, so that
+// callers can delete token runs without running clex for every variant
+static void list_tokens(void) {
+  int i;
+  for (i = 0; i < toks; i++) {
+    if (tok_list[i].kind != TOK_WS &&
+        tok_list[i].kind != TOK_NEWLINE)
+      printf("%ld\n", tok_list[i].offset);
+  }
+  exit(OK);
+}
+
+// print the [start, end) input file offsets of the comments, the strings
+// and other literals have been lexed so comment markers in them are ignored
+static void list_comments(void) {
+  int i;
+  for (i = 0; i < comments; i++)
+    printf("%ld %ld\n", comment_list[i].start, comment_list[i].end);
+  exit(OK);
+}
+
 static void print_pattern(unsigned char c) {
   int z;
   for (z = 0; z < 8; z++) {
@@ -380,6 +449,184 @@ static void rm_tok_pattern(int idx) {
   }
 }
 
+enum bracket_kind { PARENS, SQUARES, CURLIES, N_BRACKETS };
+
+static int bracket(const char *s, int *delta) {
+  static const char *open[N_BRACKETS][2] = {{"(", "("}, {"[", "<:"}, {"{", "<%"}};
+  static const char *close[N_BRACKETS][2] = {{")", ")"}, {"]", ":>"}, {"}", "%>"}};
+  int kind;
+  for (kind = 0; kind < N_BRACKETS; kind++) {
+    if (strcmp(s, open[kind][0]) == 0 || strcmp(s, open[kind][1]) == 0) {
+      *delta = 1;
+      return kind;
+    }
+    if (strcmp(s, close[kind][0]) == 0 || strcmp(s, close[kind][1]) == 0) {
+      *delta = -1;
+      return kind;
+    }
+  }
+  return -1;
+}
+
+static int is_one_of(const char *s, const char *const *list) {
+  for (; *list; list++) {
+    if (strcmp(s, *list) == 0)
+      return 1;
+  }
+  return 0;
+}
+
+// binary operators that can't be used without a right operand
+static const char *const right_operand_ops[] = {
+  "=", "+=", "-=", "*=", "/=", "%=", "&=", "^=", "|=", "<<=", ">>=", "==",
+  "!=", "<=", ">=", "<=>", "||", "/", "%", "^", "|", "<<", "->", "->*",
+  ".", ".*", NULL,
+};
+
+// and those that can't be used without a left operand either
+static const char *const left_operand_ops[] = {
+  "+=", "-=", "*=", "/=", "%=", "&=", "^=", "|=", "<<=", ">>=", "==", "!=",
+  "<=", ">=", "<=>", "||", "/", "%", "^", "|", "<<", "->", "->*", ".*", NULL,
+};
+
+static const char *const comma_before[] = {",", "(", "[", "{", NULL};
+static const char *const comma_after[] = {",", ")", "]", NULL};
+static const char *const op_after[] = {")", "]", "}", ";", ",", NULL};
+static const char *const op_before[] = {"(", "{", ";", ",", NULL};
+// an operator after these is a name, e.g., operator==, or a lambda capture
+// default, e.g., [=, &x]
+static const char *const op_name_before[] = {"operator", "[", "<:", NULL};
+
+/*
+ * Would a deletion make the tokens l and r adjacent in a way that never
+ * occurs in valid code (a dangling comma or operator)? ll is the token
+ * left of l, NULL if there is none.
+ */
+static int bad_neighbors(const char *ll, const char *l, const char *r) {
+  if (ll && is_one_of(ll, op_name_before))
+    return 0;
+  if (strcmp(r, ",") == 0 && is_one_of(l, comma_before))
+    return 1;
+  if (strcmp(l, ",") == 0 && is_one_of(r, comma_after))
+    return 1;
+  if (is_one_of(l, right_operand_ops) &&
+      (is_one_of(r, op_after) || is_one_of(r, left_operand_ops)))
+    return 1;
+  if (is_one_of(r, left_operand_ops) && is_one_of(l, op_before))
+    return 1;
+  return 0;
+}
+
+/*
+ * Can deleting the pattern pat (bit k for the k-th token) of the window
+ * starting at the significant token pos possibly give a valid program?
+ * sig holds the indices of the n_sig significant (non-whitespace) tokens,
+ * depth[j] the bracket depths before the significant token j.
+ */
+static int pattern_survives(const int *sig, int n_sig, int (*depth)[N_BRACKETS],
+                            int pos, unsigned pat) {
+  int avail = n_sig - pos < n_toks ? n_sig - pos : n_toks;
+  // patterns that differ only beyond the last token give the same variant
+  if (pat >> avail)
+    return 0;
+
+  int deleted[N_BRACKETS] = {0};
+  int k, kind;
+  for (k = 0; k < avail; k++) {
+    int delta;
+    kind = bracket(tok_list[sig[pos + k]].str, &delta);
+    if (kind >= 0 && (pat & (1u << k)))
+      deleted[kind] += delta;
+    // the brackets of the remainder may not close more than the original
+    for (kind = 0; kind < N_BRACKETS; kind++) {
+      int orig = depth[pos + k + 1][kind];
+      if (orig - deleted[kind] < (orig < 0 ? orig : 0))
+        return 0;
+    }
+  }
+  for (kind = 0; kind < N_BRACKETS; kind++) {
+    if (deleted[kind])
+      return 0;
+  }
+
+  // check the neighbors of every run of deleted tokens
+  for (k = 0; k < avail; k++) {
+    if (!(pat & (1u << k)) || (k > 0 && (pat & (1u << (k - 1)))))
+      continue;
+    int end = k;
+    while (end < avail && (pat & (1u << end)))
+      end++;
+    int l = pos + k - 1;
+    int r = pos + end;
+    // the token left of l in the variant, skipping the deleted ones
+    int ll = l - 1;
+    while (ll >= pos && (pat & (1u << (ll - pos))))
+      ll--;
+    if (l >= 0 && r < n_sig &&
+        bad_neighbors(ll >= 0 ? tok_list[sig[ll]].str : NULL,
+                      tok_list[sig[l]].str, tok_list[sig[r]].str))
+      return 0;
+  }
+  return 1;
+}
+
+static void print_index_range(long first, long last) {
+  if (first == last)
+    printf("%ld\n", first);
+  else
+    printf("%ld-%ld\n", first, last);
+}
+
+/*
+ * Print the rm-tok-pattern indices whose variants pass the cheap lexical
+ * checks above, runs of consecutive indices as first-last.
+ */
+static void list_rm_tok_patterns(void) {
+  int n_patterns = 1 << (n_toks - 1);
+  int *sig = malloc((toks + 1) * sizeof(int));
+  int (*depth)[N_BRACKETS] = malloc((toks + 1) * sizeof(*depth));
+  assert(sig && depth);
+
+  int n_sig = 0;
+  int i, kind;
+  for (kind = 0; kind < N_BRACKETS; kind++)
+    depth[0][kind] = 0;
+  for (i = 0; i < toks; i++) {
+    if (tok_list[i].kind == TOK_WS || tok_list[i].kind == TOK_NEWLINE)
+      continue;
+    memcpy(depth[n_sig + 1], depth[n_sig], sizeof(*depth));
+    int delta;
+    kind = bracket(tok_list[i].str, &delta);
+    if (kind >= 0)
+      depth[n_sig + 1][kind] += delta;
+    sig[n_sig++] = i;
+  }
+
+  long first = -1;
+  long last = -1;
+  int pos, n_pattern;
+  for (pos = 0; pos < n_sig; pos++) {
+    for (n_pattern = 0; n_pattern < n_patterns; n_pattern++) {
+      unsigned pat = 1 | ((unsigned)n_pattern << 1);
+      if (!pattern_survives(sig, n_sig, depth, pos, pat))
+        continue;
+      long idx = ((long)pos << (n_toks - 1)) | n_pattern;
+      if (idx != last + 1 || first < 0) {
+        if (first >= 0)
+          print_index_range(first, last);
+        first = idx;
+      }
+      last = idx;
+    }
+  }
+  if (first >= 0)
+    print_index_range(first, last);
+
+  free(sig);
+  free(depth);
+  exit(OK);
+}
+
 // handle simple #defines
 // todo: handle macro arguments
 // todo: handle undefinition, redefinition, and other cases
@@ -440,8 +687,21 @@ void define(int tok_index) {
 }
 
 int main(int argc, char *argv[]) {
+  const char *prog = argv[0];
+  // the language defaults to the one implied by the file extension
+  const char *lang = NULL;
+  if (argc > 1 && strncmp(argv[1], "--lang=", 7) == 0) {
+    lang = &argv[1][7];
+    if (strcmp(lang, "c") != 0 && strcmp(lang, "c++") != 0) {
+      printf("error: unknown language '%s'\n", lang);
+      exit(STOP);
+    }
+    argc--;
+    argv++;
+  }
+
   if (argc != 4) {
-    printf("USAGE: %s command index file\n", argv[0]);
+    printf("USAGE: %s [--lang=c|c++] command index file\n", prog);
     exit(STOP);
   }
 
@@ -462,11 +722,20 @@ int main(int argc, char *argv[]) {
     int res = sscanf(&cmd[8], "%d", &n_toks);
     assert(res == 1);
     assert(n_toks > 0 && n_toks <= 1000);
+  } else if (strcmp(cmd, "list-tokens") == 0) {
+    mode = MODE_LIST_TOKENS;
+  } else if (strcmp(cmd, "list-comments") == 0) {
+    mode = MODE_LIST_COMMENTS;
   } else if (strncmp(cmd, "rm-tok-pattern-", 15) == 0) {
     mode = MODE_RM_TOK_PATTERN;
     int res = sscanf(&cmd[15], "%d", &n_toks);
     assert(res == 1);
     assert(n_toks > 1 && n_toks <= 8);
+  } else if (strncmp(cmd, "list-rm-tok-pattern-", 20) == 0) {
+    mode = MODE_LIST_RM_TOK_PATTERN;
+    int res = sscanf(&cmd[20], "%d", &n_toks);
+    assert(res == 1);
+    assert(n_toks > 1 && n_toks <= 8);
   } else if (strcmp(cmd, "define") == 0) {
     mode = MODE_DEFINE;
   } else {
@@ -485,6 +754,9 @@ int main(int argc, char *argv[]) {
   }
   yyin = in;
 
+  if (lang ? strcmp(lang, "c++") == 0 : is_cxx_file(argv[3]))
+    set_cxx_mode();
+
   max_toks = initial_length;
   tok_list = (struct tok_t *)malloc(max_toks * sizeof(struct tok_t));
   assert(tok_list);
@@ -511,9 +783,18 @@ int main(int argc, char *argv[]) {
   case MODE_RM_TOKS:
     rm_toks(tok_index);
     __builtin_unreachable();
+  case MODE_LIST_TOKENS:
+    list_tokens();
+    __builtin_unreachable();
+  case MODE_LIST_COMMENTS:
+    list_comments();
+    __builtin_unreachable();
   case MODE_RM_TOK_PATTERN:
     rm_tok_pattern(tok_index);
     __builtin_unreachable();
+  case MODE_LIST_RM_TOK_PATTERN:
+    list_rm_tok_patterns();
+    __builtin_unreachable();
   case MODE_DEFINE:
     define(tok_index);
     __builtin_unreachable();
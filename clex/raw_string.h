@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2013, 2014, 2015, 2016 The University of Utah
+ * All rights reserved.
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License.  See the file COPYING for details.
+ */
+
+/*
+ * The raw string literals of the C++ mode, shared by clex and strlex. The
+ * scanners include this file in their user code section, where yytext and
+ * read_char() are visible, after defining RAW_STRING_EOF() to handle an
+ * unterminated literal.
+ */
+
+#ifndef RAW_STRING_H
+#define RAW_STRING_H
+
+#include <string.h>
+
+/*
+ * yytext holds R"delim( with an optional encoding prefix, read up to the
+ * matching )delim" and emit the whole literal as one token.
+ */
+static void scan_raw_string(void)
+{
+  size_t len = strlen(yytext);
+  size_t size = 2 * len + 64;
+  char *text = malloc(size);
+  assert(text);
+  memcpy(text, yytext, len);
+
+  char closing[20];
+  const char *delim = strchr(yytext, '"') + 1;
+  size_t closing_len = len - (delim - yytext) + 1;
+  closing[0] = ')';
+  memcpy(closing + 1, delim, closing_len - 2);
+  closing[closing_len - 1] = '"';
+
+  size_t start = len;
+  for ( ; ; ) {
+    int c = read_char();
+    if (c == EOF) {
+      RAW_STRING_EOF();
+    }
+    if (len + 1 >= size) {
+      size *= 2;
+      text = realloc(text, size);
+      assert(text);
+    }
+    text[len++] = c;
+    if (len - start >= closing_len &&
+        memcmp(text + len - closing_len, closing, closing_len) == 0)
+      break;
+  }
+  text[len] = 0;
+
+  process_token_text(text, TOK_OTHER);
+  free(text);
+}
+
+#endif /* RAW_STRING_H */
@@ -8,6 +8,7 @@ import logging
 import os
 import os.path
 import platform
+import shlex
 import shutil
 import sys
 import tempfile
@@ -22,10 +23,11 @@ if importlib.util.find_spec('cvise') is None:
 
 import chardet  # noqa: E402
 from cvise.cvise import CVise  # noqa: E402
-from cvise.passes.abstract import AbstractPass  # noqa: E402
+from cvise.passes.abstract import AbstractPass, AdaptiveChunking  # noqa: E402
 from cvise.utils import misc, statistics, testing  # noqa: E402
 from cvise.utils.error import CViseError  # noqa: E402
 from cvise.utils.error import MissingPassGroupsError  # noqa: E402
+from cvise.utils.regions import FocusRegions  # noqa: E402
 import psutil  # noqa: E402
 
 
@@ -62,7 +64,6 @@ def find_external_programs():
         'clex': 'clex',
         'topformflat': 'delta',
         'unifdef': None,
-        'gcov-dump': None,
     }
 
     for prog, local_folder in programs.items():
@@ -256,6 +257,12 @@ if __name__ == '__main__':
         action='store_true',
         help='Print timestamps instead of relative time from a reduction start',
     )
+    parser.add_argument(
+        '--fast-test',
+        metavar='SCRIPT',
+        help='A cheap interestingness test (e.g. a -fsyntax-only compile) run before INTERESTINGNESS_TEST; '
+        + 'the full test runs only for the variants it accepts',
+    )
     parser.add_argument(
         '--timeout',
         type=int,
@@ -294,6 +301,39 @@ if __name__ == '__main__':
         type=str,
         help='Preserve the given function in replace-function-def-with-decl clang delta pass',
     )
+    parser.add_argument(
+        '--clang-delta-compile-commands',
+        type=str,
+        help='compile_commands.json (or its directory) with the flags clang_delta parses the test case with',
+    )
+    parser.add_argument(
+        '--clang-delta-ast-cache',
+        type=str,
+        help='Directory where clang_delta keeps the parsed test cases, so that each one is parsed only once',
+    )
+    parser.add_argument(
+        '--clang-delta-ast-cache-size',
+        type=int,
+        help='Size in MiB the clang_delta AST cache is kept under by removing the least recently used files',
+    )
+    parser.add_argument(
+        '--clang-delta-region',
+        action='append',
+        metavar='OFFSET:LENGTH',
+        help='Byte range of the test case the clang_delta passes are restricted to (can be given several times)',
+    )
+    parser.add_argument(
+        '--clang-delta-args',
+        type=str,
+        help='Additional compiler flags for clang_delta, e.g. --clang-delta-args="-DNDEBUG -isystem /opt/include"',
+    )
+    parser.add_argument(
+        '--chunking',
+        type=str,
+        choices=['adaptive', 'halving'],
+        default='halving',
+        help='Granularity strategy of the binary search passes: halving only halves the chunks after each sweep, adaptive also grows them after a streak of successes and splits them evenly among the cores',
+    )
     parser.add_argument(
         '--not-c',
         action='store_true',
@@ -398,6 +438,23 @@ if __name__ == '__main__':
         args.not_c,
         args.renaming,
     )
+    if args.chunking == 'adaptive':
+        chunking = AdaptiveChunking(args.n)
+        for p in chain(*pass_group.values()):
+            p.chunking = chunking
+
+    clang_delta_args = []
+    if args.clang_delta_compile_commands:
+        clang_delta_args.append(f'--compile-commands={os.path.abspath(args.clang_delta_compile_commands)}')
+    if args.clang_delta_ast_cache:
+        clang_delta_args.append(f'--ast-cache={os.path.abspath(args.clang_delta_ast_cache)}')
+        if args.clang_delta_ast_cache_size is not None:
+            clang_delta_args.append(f'--ast-cache-size={args.clang_delta_ast_cache_size}')
+    if args.clang_delta_args:
+        clang_delta_args += ['--'] + shlex.split(args.clang_delta_args)
+    for p in chain(*pass_group.values()):
+        p.clang_delta_args = clang_delta_args
+
     if args.list_passes:
         logging.info('Available passes:')
         logging.info('INITIAL PASSES')
@@ -431,6 +488,18 @@ if __name__ == '__main__':
         args.test_cases.insert(0, args.interestingness_test)
         args.interestingness_test = None
 
+    if args.clang_delta_region:
+        if len(args.test_cases) > 1:
+            print('--clang-delta-region can only be used with a single test case!')
+            sys.exit(1)
+        try:
+            focus_regions = FocusRegions.parse(args.clang_delta_region)
+        except ValueError as e:
+            print(f'--clang-delta-region: {e}')
+            sys.exit(1)
+        for p in chain(*pass_group.values()):
+            p.focus_regions = focus_regions
+
     if args.to_utf8:
         for test_case in args.test_cases:
             with open(test_case, 'rb') as fd:
@@ -468,6 +537,7 @@ if __name__ == '__main__':
         args.start_with_pass,
         args.skip_after_n_transforms,
         args.stopping_threshold,
+        fast_test=args.fast_test,
     )
 
     reducer = CVise(test_manager, args.skip_interestingness_test_check)
@@ -512,6 +582,27 @@ if __name__ == '__main__':
                 )
             fs.write('\n')
 
+            if args.fast_test:
+                fs.write('===< TEST statistics >===\n')
+                fs.write(
+                    '  %-20s %8s %8s %10s %10s %12s\n'
+                    % ('test', 'executed', 'passed', 'pass (%)', 'time (s)', 'average (s)')
+                )
+                for tier in test_manager.test_statistic.tiers:
+                    executed = max(tier.executed, 1)
+                    fs.write(
+                        '  %-20s %8d %8d %10.2f %10.2f %12.3f\n'
+                        % (
+                            tier.name,
+                            tier.executed,
+                            tier.passed,
+                            100.0 * tier.passed / executed,
+                            tier.total_seconds,
+                            tier.total_seconds / executed,
+                        )
+                    )
+                fs.write('\n')
+
             if not args.no_timing:
                 fs.write(f'Runtime: {round(time_stop - time_start)} seconds\n')
 
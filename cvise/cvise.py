@@ -4,9 +4,11 @@ import os
 
 from cvise.passes.abstract import AbstractPass
 from cvise.passes.balanced import BalancedPass
+from cvise.passes.binary import BinaryRecordsPass
 from cvise.passes.blank import BlankPass
 from cvise.passes.clang import ClangPass
 from cvise.passes.clangbinarysearch import ClangBinarySearchPass
+from cvise.passes.clangpipeline import ClangPipelinePass
 from cvise.passes.clex import ClexPass
 from cvise.passes.comments import CommentsPass
 from cvise.passes.gcdabinary import GCDABinaryPass
@@ -20,6 +22,7 @@ from cvise.passes.lines import LinesPass
 from cvise.passes.peep import PeepPass
 from cvise.passes.special import SpecialPass
 from cvise.passes.ternary import TernaryPass
+from cvise.passes.tokens import TokensPass
 from cvise.passes.unifdef import UnIfDefPass
 from cvise.utils.error import CViseError, PassOptionError
 
@@ -38,9 +41,11 @@ class CVise:
 
     pass_name_mapping = {
         'balanced': BalancedPass,
+        'binary-records': BinaryRecordsPass,
         'blank': BlankPass,
         'clang': ClangPass,
         'clangbinarysearch': ClangBinarySearchPass,
+        'clangpipeline': ClangPipelinePass,
         'clex': ClexPass,
         'comments': CommentsPass,
         'gcda-binary': GCDABinaryPass,
@@ -54,6 +59,7 @@ class CVise:
         'peep': PeepPass,
         'special': SpecialPass,
         'ternary': TernaryPass,
+        'tokens': TokensPass,
         'unifdef': UnIfDefPass,
     }
 
@@ -178,22 +184,26 @@ class CVise:
                 if not p.check_prerequisites():
                     logging.error(f'Prereqs not found for pass {p}')
 
+    @staticmethod
+    def _next_pass(passes, i):
+        return passes[i + 1] if i + 1 < len(passes) else None
+
     def _run_additional_passes(self, passes):
-        for p in passes:
+        for i, p in enumerate(passes):
             if not p.check_prerequisites():
                 logging.error(f'Skipping {p}')
             else:
-                self.test_manager.run_pass(p)
+                self.test_manager.run_pass(p, self._next_pass(passes, i))
 
     def _run_main_passes(self, passes):
         while True:
             total_file_size = self.test_manager.total_file_size
 
             met_stopping_threshold = False
-            for p in passes:
+            for i, p in enumerate(passes):
                 # Exit early if we're already reduced enough
                 improvement = (
-                    self.test_manager.orig_total_file_size - total_file_size
+                    self.test_manager.orig_total_file_size - self.test_manager.total_file_size
                 ) / self.test_manager.orig_total_file_size
                 logging.debug(
                     f'Termination check: stopping threshold is {self.test_manager.stopping_threshold}; current improvement is {improvement:.1f}'
@@ -204,7 +214,7 @@ class CVise:
                 if not p.check_prerequisites():
                     logging.error(f'Skipping pass {p}')
                 else:
-                    self.test_manager.run_pass(p)
+                    self.test_manager.run_pass(p, self._next_pass(passes, i))
 
             logging.info(f'Termination check: size was {total_file_size}; now {self.test_manager.total_file_size}')
 
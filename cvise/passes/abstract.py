@@ -1,6 +1,8 @@
 import copy
 from enum import auto, Enum, unique
 import logging
+import math
+import os
 import shutil
 import subprocess
 
@@ -13,7 +15,90 @@ class PassResult(Enum):
     ERROR = auto()
 
 
+class ChunkingStrategy:
+    """Classic binary search granularity: halve the chunk after each sweep, never grow it."""
+
+    def reduce(self, state):
+        """Return the chunk used for the next sweep; a value below 1 ends the search."""
+        return int(state.chunk / 2)
+
+    def grow(self, state):
+        """Return the chunk used after a successful transformation."""
+        return state.chunk
+
+
+class AdaptiveChunking(ChunkingStrategy):
+    """ddmin-like granularity that adapts to the success rate.
+
+    Removing a chunk is the ddmin complement test. After GROWTH_STREAK consecutive
+    successes the chunk is doubled again, and a new sweep splits the instances into chunks
+    of equal size whose count is a multiple of the number of workers, so each batch
+    of parallel tests covers a contiguous part of the instances evenly.
+    """
+
+    GROWTH_STREAK = 3
+
+    def __init__(self, workers=1):
+        self.workers = max(1, workers)
+
+    def __repr__(self):
+        return f'AdaptiveChunking(workers: {self.workers})'
+
+    def reduce(self, state):
+        chunk = super().reduce(state)
+        if chunk < 1:
+            return chunk
+        chunks = math.ceil(state.instances / chunk)
+        if chunks > self.workers:
+            chunks = math.ceil(chunks / self.workers) * self.workers
+        return math.ceil(state.instances / chunks)
+
+    def grow(self, state):
+        if state.success_streak < self.GROWTH_STREAK:
+            return state.chunk
+        return min(state.chunk * 2, state.instances)
+
+
+class ProgressEstimate:
+    """Expected outcome of testing a state: the success probability and the bytes removed on success.
+
+    The outcomes of the tested states are recorded in the ProgressHistory of the job under
+    key, so that the estimates of the states with the same key follow the observed success rate.
+    """
+
+    def __init__(self, probability, gain, key=None):
+        self.probability = probability
+        self.gain = gain
+        self.key = key
+
+    def __repr__(self):
+        return f'ProgressEstimate(probability: {self.probability:.2f}, gain: {self.gain:.0f}, key: {self.key})'
+
+    @property
+    def expected_gain(self):
+        return self.probability * self.gain
+
+
+class ProgressHistory:
+    """Test outcomes of the states of a job, grouped by the keys of their estimates."""
+
+    def __init__(self):
+        # key -> (tested, succeeded)
+        self.outcomes = {}
+
+    def record(self, key, success):
+        (tested, succeeded) = self.outcomes.get(key, (0, 0))
+        self.outcomes[key] = (tested + 1, succeeded + int(success))
+
+    def success_rate(self, key):
+        """Return the success rate of the key, with a prior of 1/2 for the untested keys."""
+        (tested, succeeded) = self.outcomes.get(key, (0, 0))
+        return (succeeded + 1) / (tested + 2)
+
+
 class BinaryState:
+    default_strategy = ChunkingStrategy()
+
     def __init__(self):
         pass
 
@@ -21,13 +106,15 @@ class BinaryState:
         return f'BinaryState({self.index}-{self.end()}, {self.instances} instances, step: {self.chunk})'
 
     @staticmethod
-    def create(instances):
+    def create(instances, strategy=None):
         if not instances:
             return None
         self = BinaryState()
         self.instances = instances
         self.chunk = instances
         self.index = 0
+        self.success_streak = 0
+        self.strategy = strategy if strategy is not None else BinaryState.default_strategy
         return self
 
     def copy(self):
@@ -39,11 +126,16 @@ class BinaryState:
     def real_chunk(self):
         return self.end() - self.index
 
+    def estimate_progress(self, size, history):
+        """Estimate the removal of the chunk from a test case of size bytes, keyed by the chunk size."""
+        return ProgressEstimate(history.success_rate(self.chunk), size * self.real_chunk() / self.instances, self.chunk)
+
     def advance(self):
         self = self.copy()
+        self.success_streak = 0
         self.index += self.chunk
         if self.index >= self.instances:
-            self.chunk = int(self.chunk / 2)
+            self.chunk = self.strategy.reduce(self)
             if self.chunk < 1:
                 return None
             logging.debug(f'granularity reduced to {self.chunk}')
@@ -56,6 +148,12 @@ class BinaryState:
         if not instances:
             return None
         self.instances = instances
+        self.success_streak += 1
+        chunk = self.strategy.grow(self)
+        if chunk > self.chunk:
+            logging.debug(f'granularity increased to {chunk}')
+            self.chunk = chunk
+            self.success_streak = 0
         if self.index >= self.instances:
             return self.advance()
         else:
@@ -68,9 +166,27 @@ class AbstractPass:
         slow = 'slow'
         windows = 'windows'
 
+    # clang_delta exit code when every instance of the range crashed
+    CLANG_DELTA_CRASHED_INSTANCES = 2
+    # clang_delta exit code when the transformation crashed outside of the instances, e.g., while parsing
+    CLANG_DELTA_CRASHED = 3
+
     def __init__(self, arg=None, external_programs=None):
         self.external_programs = external_programs
         self.arg = arg
+        # granularity strategy of BinaryState based passes, None means plain halving
+        self.chunking = None
+        # extra clang_delta arguments that make it parse the test case like the real build
+        self.clang_delta_args = []
+        # FocusRegions the clang_delta passes are restricted to, shared by all the passes
+        self.focus_regions = None
+        # data derived from the test case by the coordinator, never sent to the workers
+        self.local_cache = None
+
+    def __getstate__(self):
+        state = self.__dict__.copy()
+        state['local_cache'] = None
+        return state
 
     def __repr__(self):
         if self.arg is not None:
@@ -91,6 +207,14 @@ class AbstractPass:
             logging.error(f'cannot find external program {name}')
         return result
 
+    def clang_delta_region_args(self):
+        return self.focus_regions.clang_delta_args() if self.focus_regions is not None else []
+
+    def report_clang_delta_crash(self, stderr, process_event_notifier):
+        for line in stderr.splitlines():
+            if line.startswith('Crash signature:'):
+                process_event_notifier.report_once(f'clang_delta {self.arg}: {line}')
+
     def check_prerequisites(self):
         raise NotImplementedError(f"Class {type(self).__name__} has not implemented 'check_prerequisites'!")
 
@@ -103,6 +227,24 @@ class AbstractPass:
     def advance_on_success(self, test_case, state):
         raise NotImplementedError(f"Class {type(self).__name__} has not implemented 'advance_on_success'!")
 
+    def on_failure(self, test_case, state):
+        """Called by the coordinator when the variant of state was tested without success."""
+        pass
+
+    def on_other_success(self, test_case):
+        """Called by the coordinator when a variant of another test case than test_case was kept."""
+        pass
+
+    def estimate_progress(self, test_case, state, history):
+        """Return the ProgressEstimate of testing state, or None if the states can't be told apart.
+
+        The scheduler tests the pending states with the highest expected gain first; the states
+        of a pass without estimates are tested in the order of advance.
+        """
+        if isinstance(state, BinaryState):
+            return state.estimate_progress(os.path.getsize(test_case), history)
+        return None
+
     def transform(self, test_case, state, process_event_notifier):
         raise NotImplementedError(f"Class {type(self).__name__} has not implemented 'transform'!")
 
@@ -122,8 +264,13 @@ class ProcessEvent:
 class ProcessEventNotifier:
     def __init__(self, pid_queue):
         self.pid_queue = pid_queue
+        # warnings the coordinator logs once per pass, as the same problem shows up in many variants
+        self.messages = []
+
+    def report_once(self, message):
+        self.messages.append(message)
 
-    def run_process(self, cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, shell=False):
+    def run_process(self, cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, shell=False, cwd=None):
         if shell:
             assert isinstance(cmd, str)
         proc = subprocess.Popen(
@@ -133,6 +280,7 @@ class ProcessEventNotifier:
             universal_newlines=True,
             encoding='utf8',
             shell=shell,
+            cwd=cwd,
         )
         if self.pid_queue:
             self.pid_queue.put(ProcessEvent(proc.pid, ProcessEventType.STARTED))
@@ -11,10 +11,17 @@ class BalancedPass(AbstractPass):
         with open(test_case) as in_file:
             prog = in_file.read()
 
-        config = self.__get_config()
-        m = nestedmatcher.find(config['search'], prog, pos=pos, prefix=config['prefix'])
-
-        return m
+        if self.local_cache is None or self.local_cache[0] != prog:
+            config = self.__get_config()
+            parts = [nestedmatcher.BalancedPattern(config['search'])]
+            if config['prefix']:
+                parts.insert(0, nestedmatcher.RegExPattern(config['prefix']))
+            self.local_cache = (prog, nestedmatcher.MatchIndex(parts, prog))
+
+        m = self.local_cache[1].next(pos)
+        if m is None:
+            return None
+        return m['all']
 
     def new(self, test_case, _=None):
         return self.__get_next_match(test_case, pos=0)
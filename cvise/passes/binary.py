@@ -0,0 +1,53 @@
+import mmap
+import os
+
+from cvise.passes.abstract import AbstractPass, BinaryState, PassResult
+from cvise.utils import binaryrecords, splice
+from cvise.utils.error import UnknownArgumentError
+
+
+class BinaryRecordsPass(AbstractPass):
+    """Remove chunks of the records of a binary file; the argument selects the record format."""
+
+    def check_prerequisites(self):
+        return True
+
+    def get_splitter(self):
+        splitter = binaryrecords.get_splitter(self.arg)
+        if splitter is None:
+            raise UnknownArgumentError(self.__class__.__name__, self.arg)
+        return splitter
+
+    def __split(self, test_case, first=None, last=None):
+        """Return the records of test_case, or the pieces of the variant without the records first to last - 1."""
+        splitter = self.get_splitter()
+        with open(test_case, 'rb') as f:
+            if not os.fstat(f.fileno()).st_size:
+                return None
+            with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+                records = splitter(data)
+                if records is None or first is None:
+                    return records
+                return records.pieces(first, last)
+
+    def new(self, test_case, check_sanity=None):
+        records = self.__split(test_case)
+        if records is None:
+            return None
+        return BinaryState.create(len(records), self.chunking)
+
+    def advance(self, test_case, state):
+        return state.advance()
+
+    def advance_on_success(self, test_case, state):
+        records = self.__split(test_case)
+        if records is None:
+            return None
+        return state.advance_on_success(len(records))
+
+    def transform(self, test_case, state, process_event_notifier):
+        pieces = self.__split(test_case, state.index, state.end())
+        if pieces is None:
+            return (PassResult.STOP, state)
+        splice.splice_file(test_case, pieces)
+        return (PassResult.OK, state)
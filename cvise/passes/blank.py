@@ -1,12 +1,15 @@
-import os
 import re
-import shutil
-import tempfile
 
 from cvise.passes.abstract import AbstractPass, PassResult
+from cvise.utils import splice
 
 
 class BlankPass(AbstractPass):
+    patterns = [
+        re.compile(rb'^[^\S\n]*$', flags=re.MULTILINE),
+        re.compile(rb'^#', flags=re.MULTILINE),
+    ]
+
     def check_prerequisites(self):
         return True
 
@@ -19,36 +22,13 @@ class BlankPass(AbstractPass):
     def advance_on_success(self, test_case, state):
         return state
 
-    @staticmethod
-    def __transform(test_case, pattern):
-        tmp = os.path.dirname(test_case)
-        with tempfile.NamedTemporaryFile(mode='w+', delete=False, dir=tmp) as tmp_file:
-            with open(test_case) as in_file:
-                matched = False
-
-                for line in in_file:
-                    if re.match(pattern, line) is not None:
-                        matched = True
-                    else:
-                        tmp_file.write(line)
-
-        if matched:
-            shutil.move(tmp_file.name, test_case)
-        else:
-            os.unlink(tmp_file.name)
-
-        return matched
-
     def transform(self, test_case, state, process_event_notifier):
-        patterns = [r'^\s*$', r'^#']
-
-        if state >= len(patterns):
-            return (PassResult.STOP, state)
-        else:
-            success = False
-
-            while not success and state < len(patterns):
-                success = self.__transform(test_case, patterns[state])
-                state += 1
-
-            return (PassResult.OK if success else PassResult.STOP, state)
+        while state < len(self.patterns):
+            # remove all the lines matching the pattern at once
+            ranges = splice.line_ranges(test_case, self.patterns[state])
+            state += 1
+            if ranges:
+                splice.remove_ranges(test_case, ranges)
+                return (PassResult.OK, state)
+
+        return (PassResult.STOP, state)
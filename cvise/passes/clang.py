@@ -29,11 +29,11 @@ class ClangPass(AbstractPass):
             ]
             if self.user_clang_delta_std:
                 args.append(f'--std={self.user_clang_delta_std}')
-            cmd = args + [test_case]
+            cmd = args + self.clang_delta_region_args() + [test_case] + self.clang_delta_args
 
             logging.debug(' '.join(cmd))
 
-            stdout, _, returncode = process_event_notifier.run_process(cmd)
+            stdout, stderr, returncode = process_event_notifier.run_process(cmd)
             if returncode == 0:
                 tmp_file.write(stdout)
                 tmp_file.close()
@@ -42,5 +42,8 @@ class ClangPass(AbstractPass):
             else:
                 if returncode == 255 or returncode == 1:
                     return (PassResult.STOP, state)
+                self.report_clang_delta_crash(stderr, process_event_notifier)
+                if returncode == self.CLANG_DELTA_CRASHED_INSTANCES:
+                    return (PassResult.INVALID, state)
                 else:
                     return (PassResult.ERROR, state)
@@ -38,7 +38,7 @@ class ClangBinarySearchPass(AbstractPass):
             self.detect_best_standard(test_case)
         else:
             self.clang_delta_std = self.user_clang_delta_std
-        return BinaryState.create(self.count_instances(test_case))
+        return BinaryState.create(self.count_instances(test_case), self.chunking)
 
     def advance(self, test_case, state):
         return state.advance()
@@ -59,7 +59,7 @@ class ClangBinarySearchPass(AbstractPass):
         ]
         if self.clang_delta_preserve_routine:
             args.append(f'--preserve-routine="{self.clang_delta_preserve_routine}"')
-        cmd = args + [test_case]
+        cmd = args + self.clang_delta_region_args() + [test_case] + self.clang_delta_args
 
         try:
             proc = subprocess.run(cmd, text=True, capture_output=True, timeout=self.QUERY_TIMEOUT)
@@ -84,7 +84,7 @@ class ClangBinarySearchPass(AbstractPass):
         else:
             return int(m.group(1))
 
-    def parse_stderr(self, state, stderr):
+    def parse_stderr(self, state, stderr, process_event_notifier):
         for line in stderr.split('\n'):
             if line.startswith('Available transformation instances:'):
                 real_num_instances = int(line.split(':')[1])
@@ -92,6 +92,8 @@ class ClangBinarySearchPass(AbstractPass):
             elif line.startswith('Warning: number of transformation instances exceeded'):
                 # TODO: report?
                 pass
+        # the crashed instances are left out of the variant
+        self.report_clang_delta_crash(stderr, process_event_notifier)
 
     def transform(self, test_case, state, process_event_notifier):
         logging.debug(f'TRANSFORM: {state}')
@@ -109,16 +111,18 @@ class ClangBinarySearchPass(AbstractPass):
                 args.append(f'--std={self.clang_delta_std}')
             if self.clang_delta_preserve_routine:
                 args.append(f'--preserve-routine="{self.clang_delta_preserve_routine}"')
-            cmd = [self.external_programs['clang_delta']] + args + [test_case]
+            cmd = [self.external_programs['clang_delta']] + args + self.clang_delta_region_args() + [test_case] + self.clang_delta_args
             logging.debug(' '.join(cmd))
 
             stdout, stderr, returncode = process_event_notifier.run_process(cmd)
-            self.parse_stderr(state, stderr)
+            self.parse_stderr(state, stderr, process_event_notifier)
             tmp_file.write(stdout)
             tmp_file.close()
             if returncode == 0:
                 shutil.copy(tmp_file.name, test_case)
                 return (PassResult.OK, state)
+            elif returncode == self.CLANG_DELTA_CRASHED_INSTANCES:
+                return (PassResult.INVALID, state)
             else:
                 return (
                     PassResult.STOP if returncode == 255 else PassResult.ERROR,
@@ -0,0 +1,139 @@
+import copy
+import logging
+import os
+from pathlib import Path
+import re
+import subprocess
+import tempfile
+
+from cvise.passes.abstract import AbstractPass, PassResult
+
+
+class PipelineState:
+    def __init__(self, folder, steps, outputs, failed, rest):
+        # the folder with the outputs of the steps, kept alive by the local_cache of the pass
+        self.folder = folder
+        # the transformations the pipeline was run with
+        self.steps = steps
+        # numbers of the applied steps of the outputs which changed the test case, longest first
+        self.outputs = outputs
+        # numbers of the steps which failed or crashed, they are not run again
+        self.failed = failed
+        # the steps not run because clang_delta crashed
+        self.rest = rest
+        self.index = 0
+
+    def __repr__(self):
+        return f'PipelineState({self.steps}, steps applied: {self.outputs[self.index]})'
+
+    @staticmethod
+    def create(folder, steps, outputs, failed, rest):
+        if not outputs:
+            return None
+        return PipelineState(folder, steps, outputs, failed, rest)
+
+    def output_path(self):
+        return Path(self.folder, f'step.{self.outputs[self.index]}')
+
+    def copy(self):
+        return copy.copy(self)
+
+
+class ClangPipelinePass(AbstractPass):
+    """Apply a comma-separated list of clang_delta transformations (arg) in one clang_delta process.
+
+    clang_delta parses the output of each step from memory and writes the output of every step,
+    so the test case is not parsed by a new process for each transformation. The pipeline is
+    run by the coordinator, and the states are its outputs, the longest one first: the first
+    successful state keeps as many steps as possible. The step after the kept ones is then
+    dropped, and the pipeline is run again with the remaining steps. The steps clang_delta
+    reports as failed are dropped as well; if it crashes, the outputs of the steps before the
+    crash are still tested, and the pipeline goes on with the steps after the crashed one.
+    The outputs stay in files owned by the coordinator (local_cache), the states only refer to them.
+    """
+
+    PIPELINE_TIMEOUT = 60
+    # clang_delta exit code when some steps failed, their numbers are listed on stderr
+    CLANG_DELTA_FAILED_PIPELINE_STEPS = 4
+    STEP_REGEX = re.compile(r'Pipeline step (\d+):')
+    FAILED_STEP_REGEX = re.compile(r'Failed pipeline step (\d+):')
+
+    def check_prerequisites(self):
+        return self.check_external_program('clang_delta')
+
+    def new(self, test_case, _=None):
+        return self.run_pipeline(test_case, self.arg.split(','))
+
+    def advance(self, test_case, state):
+        state = state.copy()
+        state.index += 1
+        return state if state.index < len(state.outputs) else None
+
+    def advance_on_success(self, test_case, state):
+        if state.index == 0:
+            return self.run_pipeline(test_case, state.rest)
+        # all the longer outputs have failed, the last step of the shortest of them is to blame
+        rejected = state.outputs[state.index - 1]
+        steps = [step for i, step in enumerate(state.steps[rejected:], rejected + 1) if i not in state.failed]
+        return self.run_pipeline(test_case, steps)
+
+    def run_pipeline(self, test_case, steps):
+        if not steps:
+            return None
+        if self.local_cache is None:
+            # removed with the pass once its job is done, the states of earlier runs may still be tested
+            self.local_cache = tempfile.TemporaryDirectory(prefix='cvise-pipeline-')
+        folder = tempfile.mkdtemp(dir=self.local_cache.name)
+        args = [
+            self.external_programs['clang_delta'],
+            f'--pipeline={",".join(steps)}',
+            '--counter=1',
+            f'--output={os.path.join(folder, "step")}',
+        ]
+        if self.user_clang_delta_std:
+            args.append(f'--std={self.user_clang_delta_std}')
+        # the regions are not passed, each step would move the code they point to
+        cmd = args + [str(test_case)] + self.clang_delta_args
+        logging.debug(' '.join(cmd))
+
+        try:
+            proc = subprocess.run(cmd, text=True, capture_output=True, timeout=self.PIPELINE_TIMEOUT)
+        except subprocess.TimeoutExpired:
+            logging.warning(f'clang_delta --pipeline {self.PIPELINE_TIMEOUT}s timeout reached')
+            return None
+        except subprocess.SubprocessError as e:
+            logging.warning(f'clang_delta --pipeline failed: {e}')
+            return None
+
+        if proc.returncode == 1:
+            # none of the steps changed the test case
+            return None
+
+        outputs = [step for step in range(len(steps), 0, -1) if Path(folder, f'step.{step}').exists()]
+        failed = set()
+        rest = []
+        if proc.returncode != 0:
+            logging.warning(
+                f'clang_delta --pipeline failed with exit code {proc.returncode}: {proc.stdout.strip()}'
+            )
+            started = 0
+            for line in proc.stderr.splitlines():
+                m = self.STEP_REGEX.match(line)
+                if m:
+                    started = int(m.group(1))
+                m = self.FAILED_STEP_REGEX.match(line)
+                if m:
+                    failed.add(int(m.group(1)))
+            if proc.returncode != self.CLANG_DELTA_FAILED_PIPELINE_STEPS:
+                if not started:
+                    return None
+                # the step clang_delta died in never finished, the steps after it never started
+                failed.add(started)
+                rest = steps[started:]
+                if not outputs:
+                    return self.run_pipeline(test_case, rest)
+        return PipelineState.create(folder, steps, outputs, failed, rest)
+
+    def transform(self, test_case, state, process_event_notifier):
+        Path(test_case).write_bytes(state.output_path().read_bytes())
+        return (PassResult.OK, state)
@@ -1,5 +1,9 @@
+import bisect
+import logging
 import os
 import shutil
+import subprocess
+import sys
 
 from cvise.passes.abstract import AbstractPass, PassResult
 from cvise.utils.misc import CloseableTemporaryFile
@@ -9,13 +13,51 @@ class ClexPass(AbstractPass):
     def check_prerequisites(self):
         return self.check_external_program('clex')
 
+    def __list_instances(self, test_case):
+        """Ask clex for the sorted (first, last) ranges of indices worth trying."""
+        cmd = [self.external_programs['clex'], f'list-{self.arg}', '0', test_case]
+        try:
+            proc = subprocess.run(cmd, text=True, capture_output=True)
+        except subprocess.SubprocessError as e:
+            proc = None
+            logging.warning(f'clex list-{self.arg} failed: {e}')
+        if proc is None or proc.returncode != 51:
+            # try all indices like the other modes
+            return [(0, sys.maxsize)]
+
+        ranges = []
+        for line in proc.stdout.splitlines():
+            (first, _, last) = line.partition('-')
+            ranges.append((int(first), int(last or first)))
+        return ranges
+
+    def __next_instance(self, test_case, state):
+        if self.local_cache is None:
+            self.local_cache = self.__list_instances(test_case)
+        ranges = self.local_cache
+
+        i = bisect.bisect_left(ranges, (state + 1,)) - 1
+        if i >= 0 and ranges[i][1] >= state:
+            return state
+        if i + 1 < len(ranges):
+            return ranges[i + 1][0]
+        return None
+
     def new(self, test_case, _=None):
+        if self.arg.startswith('rm-tok-pattern-'):
+            self.local_cache = None
+            return self.__next_instance(test_case, 0)
         return 0
 
     def advance(self, test_case, state):
+        if self.arg.startswith('rm-tok-pattern-'):
+            return self.__next_instance(test_case, state + 1)
         return state + 1
 
     def advance_on_success(self, test_case, state):
+        if self.arg.startswith('rm-tok-pattern-'):
+            self.local_cache = None
+            return self.__next_instance(test_case, state)
         return state
 
     def transform(self, test_case, state, process_event_notifier):
@@ -1,42 +1,64 @@
+import logging
 import re
+import subprocess
 
-from cvise.passes.abstract import AbstractPass, PassResult
+from cvise.passes.abstract import AbstractPass, BinaryState, PassResult
+from cvise.utils import splice
 
 
 class CommentsPass(AbstractPass):
+    """Remove comments, all of them first and then smaller and smaller chunks of them."""
+
+    # used when clex is not available: string and character literals are
+    # matched too so that comment markers inside them are skipped
+    comment_regex = re.compile(
+        rb'"(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\'|(?P<comment>/\*(?:\*(?!/)|[^*])*\*/|//[^\r\n]*)', flags=re.DOTALL
+    )
+
     def check_prerequisites(self):
         return True
 
+    def __list_comments(self, test_case):
+        """Return the sorted (start, end) byte ranges of the comments in test_case."""
+        if self.external_programs and self.external_programs.get('clex'):
+            cmd = [self.external_programs['clex'], 'list-comments', '0', test_case]
+            try:
+                proc = subprocess.run(cmd, text=True, capture_output=True)
+                if proc.returncode == 51:
+                    return [tuple(map(int, line.split())) for line in proc.stdout.splitlines()]
+            except subprocess.SubprocessError as e:
+                logging.warning(f'clex list-comments failed: {e}')
+
+        with open(test_case, 'rb') as f:
+            data = f.read()
+        return [m.span('comment') for m in self.comment_regex.finditer(data) if m.group('comment')]
+
+    def __create_state(self, test_case, state=None):
+        self.local_cache = self.__list_comments(test_case)
+        if state is None:
+            state = BinaryState.create(len(self.local_cache), self.chunking)
+        else:
+            state = state.advance_on_success(len(self.local_cache))
+        return self.__set_comments(test_case, state)
+
+    def __set_comments(self, test_case, state):
+        """Give state the ranges of its chunk of comments only, the ranges of all of them stay in the coordinator."""
+        if state is None:
+            return None
+        if self.local_cache is None:
+            self.local_cache = self.__list_comments(test_case)
+        state.comments = self.local_cache[state.index : state.end()]
+        return state
+
     def new(self, test_case, _=None):
-        return -2
+        return self.__create_state(test_case)
 
     def advance(self, test_case, state):
-        return state + 1
+        return self.__set_comments(test_case, state.advance())
 
     def advance_on_success(self, test_case, state):
-        return state
+        return self.__create_state(test_case, state)
 
     def transform(self, test_case, state, process_event_notifier):
-        with open(test_case) as in_file:
-            prog = in_file.read()
-            prog2 = prog
-
-        while True:
-            # TODO: remove only the nth comment
-            if state == -2:
-                # Remove all multiline comments
-                # Replace /* any number of * if not followed by / or anything but * */
-                prog2 = re.sub(r'/\*(?:\*(?!/)|[^*])*\*/', '', prog2, flags=re.DOTALL)
-            elif state == -1:
-                # Remove all single line comments
-                prog2 = re.sub(r'//.*$', '', prog2, flags=re.MULTILINE)
-            else:
-                return (PassResult.STOP, state)
-
-            if prog != prog2:
-                with open(test_case, 'w') as out_file:
-                    out_file.write(prog2)
-
-                return (PassResult.OK, state)
-            else:
-                state = self.advance(test_case, state)
+        splice.remove_ranges(test_case, state.comments)
+        return (PassResult.OK, state)
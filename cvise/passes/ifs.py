@@ -33,7 +33,7 @@ class IfPass(AbstractPass):
         return count
 
     def new(self, test_case, _=None):
-        bs = BinaryState.create(self.__count_instances(test_case))
+        bs = BinaryState.create(self.__count_instances(test_case), self.chunking)
         if bs:
             bs.value = 0
         return bs
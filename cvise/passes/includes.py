@@ -1,48 +1,37 @@
-import os
 import re
-import shutil
-import tempfile
 
 from cvise.passes.abstract import AbstractPass, PassResult
+from cvise.utils import splice
 
 
 class IncludesPass(AbstractPass):
+    include_regex = re.compile(rb'^[^\S\n]*#[^\S\n]*include', flags=re.MULTILINE)
+
     def check_prerequisites(self):
         return True
 
+    def __create_state(self, test_case, index):
+        # the ranges of all the include lines stay in the coordinator, a state has only its own
+        if self.local_cache is None:
+            self.local_cache = splice.line_ranges(test_case, self.include_regex)
+        includes = self.local_cache
+        if index >= len(includes):
+            return None
+        return {'range': includes[index], 'index': index}
+
     def new(self, test_case, _=None):
-        return 1
+        self.local_cache = None
+        return self.__create_state(test_case, 0)
 
     def advance(self, test_case, state):
-        return state + 1
+        return self.__create_state(test_case, state['index'] + 1)
 
     def advance_on_success(self, test_case, state):
-        return state
+        # the next include line has taken the place of the removed one
+        self.local_cache = None
+        return self.__create_state(test_case, state['index'])
 
     def transform(self, test_case, state, process_event_notifier):
-        tmp = os.path.dirname(test_case)
-        with tempfile.NamedTemporaryFile(mode='w+', delete=False, dir=tmp) as tmp_file:
-            with open(test_case) as in_file:
-                includes = 0
-                matched = False
-
-                for line in in_file:
-                    include_match = re.match(r'\s*#\s*include', line)
-
-                    if include_match is not None:
-                        includes += 1
-
-                        if includes == state:
-                            matched = True
-                            # Go to next include
-                            # Don't write the original line back to file
-                            continue
-
-                    tmp_file.write(line)
-
-        if matched:
-            shutil.move(tmp_file.name, test_case)
-            return (PassResult.OK, state)
-        else:
-            os.unlink(tmp_file.name)
-            return (PassResult.STOP, state)
+        # Don't write the include line back to the file
+        splice.remove_ranges(test_case, [state['range']])
+        return (PassResult.OK, state)
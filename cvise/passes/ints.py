@@ -1,11 +1,12 @@
 import re
 
 from cvise.passes.abstract import AbstractPass, PassResult
+from cvise.utils import splice
 from cvise.utils.error import UnknownArgumentError
 
 
 class IntsPass(AbstractPass):
-    border_or_space = r'(?:(?:[*,:;{}[\]()])|\s)'
+    border_or_space = rb'(?:(?:[*,:;{}[\]()])|\s)'
 
     def check_prerequisites(self):
         return True
@@ -22,11 +23,11 @@ class IntsPass(AbstractPass):
                 return m.group('pref') + m.group('numpart') + m.group('suf')
 
             config['search'] = (
-                r'(?P<pref>'
+                rb'(?P<pref>'
                 + self.border_or_space
-                + r'[+-]?(?:0|(?:0[xX]))?)[0-9a-fA-F](?P<numpart>[0-9a-fA-F]+)(?P<suf>[ULul]*'
+                + rb'[+-]?(?:0|(?:0[xX]))?)[0-9a-fA-F](?P<numpart>[0-9a-fA-F]+)(?P<suf>[ULul]*'
                 + self.border_or_space
-                + r')'
+                + rb')'
             )
         elif self.arg == 'b':
             # Delete prefix
@@ -34,11 +35,11 @@ class IntsPass(AbstractPass):
                 return m.group('del') + m.group('numpart') + m.group('suf')
 
             config['search'] = (
-                r'(?P<del>'
+                rb'(?P<del>'
                 + self.border_or_space
-                + r')(?P<pref>[+-]?(?:0|(?:0[xX])))(?P<numpart>[0-9a-fA-F]+)(?P<suf>[ULul]*'
+                + rb')(?P<pref>[+-]?(?:0|(?:0[xX])))(?P<numpart>[0-9a-fA-F]+)(?P<suf>[ULul]*'
                 + self.border_or_space
-                + r')'
+                + rb')'
             )
         elif self.arg == 'c':
             # Delete suffix
@@ -46,23 +47,23 @@ class IntsPass(AbstractPass):
                 return m.group('pref') + m.group('numpart') + m.group('del')
 
             config['search'] = (
-                r'(?P<pref>'
+                rb'(?P<pref>'
                 + self.border_or_space
-                + r'[+-]?(?:0|(?:0[xX]))?)(?P<numpart>[0-9a-fA-F]+)[ULul]+(?P<del>'
+                + rb'[+-]?(?:0|(?:0[xX]))?)(?P<numpart>[0-9a-fA-F]+)[ULul]+(?P<del>'
                 + self.border_or_space
-                + r')'
+                + rb')'
             )
         elif self.arg == 'd':
             # Hex to dec
             def replace_fn(m):
-                return m.group('pref') + str(int(m.group('numpart'), 16)) + m.group('suf')
+                return m.group('pref') + str(int(m.group('numpart'), 16)).encode() + m.group('suf')
 
             config['search'] = (
-                r'(?P<pref>'
+                rb'(?P<pref>'
                 + self.border_or_space
-                + r')(?P<numpart>0[Xx][0-9a-fA-F]+)(?P<suf>[ULul]*'
+                + rb')(?P<numpart>0[Xx][0-9a-fA-F]+)(?P<suf>[ULul]*'
                 + self.border_or_space
-                + r')'
+                + rb')'
             )
         else:
             raise UnknownArgumentError(self.__class__.__name__, self.arg)
@@ -72,13 +73,11 @@ class IntsPass(AbstractPass):
 
     def new(self, test_case, _=None):
         config = self.__get_config()
-        with open(test_case) as in_file:
-            prog = in_file.read()
-            regex = re.compile(config['search'], flags=re.DOTALL)
-            modifications = list(reversed([(m.span(), config['replace_fn'](m)) for m in regex.finditer(prog)]))
-            if not modifications:
-                return None
-            return {'modifications': modifications, 'index': 0}
+        regex = re.compile(config['search'], flags=re.DOTALL)
+        modifications = splice.find_matches(test_case, regex, config['replace_fn'])
+        if not modifications:
+            return None
+        return {'modifications': list(reversed(modifications)), 'index': 0}
 
     def advance(self, test_case, state):
         state = state.copy()
@@ -91,11 +90,5 @@ class IntsPass(AbstractPass):
         return self.new(test_case)
 
     def transform(self, test_case, state, process_event_notifier):
-        with open(test_case) as in_file:
-            data = in_file.read()
-            index = state['index']
-            ((start, end), replacement) = state['modifications'][index]
-            new_data = data[:start] + replacement + data[end:]
-            with open(test_case, 'w') as out_file:
-                out_file.write(new_data)
-                return (PassResult.OK, state)
+        splice.replace_ranges(test_case, [state['modifications'][state['index']]])
+        return (PassResult.OK, state)
@@ -1,46 +1,41 @@
-import os
 import re
-import shutil
-import tempfile
 
 from cvise.passes.abstract import AbstractPass, BinaryState, PassResult
+from cvise.utils import splice
 
 
 class LineMarkersPass(AbstractPass):
-    line_regex = re.compile('^\\s*#\\s*[0-9]+')
+    line_regex = re.compile(rb'^[^\S\n]*#[^\S\n]*[0-9]+', flags=re.MULTILINE)
 
     def check_prerequisites(self):
         return True
 
-    def __count_instances(self, test_case):
-        count = 0
-        with open(test_case) as in_file:
-            for line in in_file.readlines():
-                if self.line_regex.search(line):
-                    count += 1
-        return count
+    def __create_state(self, test_case, state=None):
+        self.local_cache = splice.line_ranges(test_case, self.line_regex)
+        if state is None:
+            state = BinaryState.create(len(self.local_cache), self.chunking)
+        else:
+            state = state.advance_on_success(len(self.local_cache))
+        return self.__set_ranges(test_case, state)
+
+    def __set_ranges(self, test_case, state):
+        """Give state the byte ranges of its line markers only, the ranges of all of them stay in the coordinator."""
+        if state is None:
+            return None
+        if self.local_cache is None:
+            self.local_cache = splice.line_ranges(test_case, self.line_regex)
+        state.ranges = self.local_cache[state.index : state.end()]
+        return state
 
     def new(self, test_case, _=None):
-        return BinaryState.create(self.__count_instances(test_case))
+        return self.__create_state(test_case)
 
     def advance(self, test_case, state):
-        return state.advance()
+        return self.__set_ranges(test_case, state.advance())
 
     def advance_on_success(self, test_case, state):
-        return state.advance_on_success(self.__count_instances(test_case))
+        return self.__create_state(test_case, state)
 
     def transform(self, test_case, state, process_event_notifier):
-        tmp = os.path.dirname(test_case)
-        with tempfile.NamedTemporaryFile(mode='w+', delete=False, dir=tmp) as tmp_file:
-            with open(test_case) as in_file:
-                i = 0
-                for line in in_file.readlines():
-                    if self.line_regex.search(line):
-                        if i < state.index or i >= state.end():
-                            tmp_file.write(line)
-                        i += 1
-                    else:
-                        tmp_file.write(line)
-
-        shutil.move(tmp_file.name, test_case)
+        splice.remove_ranges(test_case, state.ranges)
         return (PassResult.OK, state)
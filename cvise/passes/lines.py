@@ -2,9 +2,9 @@ import logging
 import os
 import shutil
 import subprocess
-import tempfile
 
 from cvise.passes.abstract import AbstractPass, BinaryState, PassResult
+from cvise.utils import splice
 from cvise.utils.error import InsaneTestCaseError
 from cvise.utils.misc import CloseableTemporaryFile
 
@@ -46,11 +46,6 @@ class LinesPass(AbstractPass):
             else:
                 shutil.copy(tmp_file.name, test_case)
 
-    def __count_instances(self, test_case):
-        with open(test_case) as in_file:
-            lines = in_file.readlines()
-            return len(lines)
-
     def new(self, test_case, check_sanity=None):
         self.bailout = False
         # None means no topformflat
@@ -59,27 +54,35 @@ class LinesPass(AbstractPass):
             if self.bailout:
                 logging.warning('Skipping pass as sanity check fails for topformflat output')
                 return None
-        instances = self.__count_instances(test_case)
-        return BinaryState.create(instances)
+        self.local_cache = splice.line_offsets(test_case)
+        return self.__set_range(test_case, BinaryState.create(len(self.local_cache) - 1, self.chunking))
+
+    def __set_range(self, test_case, state):
+        """Give state the byte range of its lines, so that transform splices the file without reading it.
+
+        The line start offsets stay with the pass in the coordinator.  Lines end at \n only:
+        a CRLF line keeps its \r, and unlike text-mode reading, a lone \r does not end a line.
+        """
+        if state is None:
+            return None
+        if self.local_cache is None:
+            self.local_cache = splice.line_offsets(test_case)
+        offsets = self.local_cache
+        state.start = offsets[state.index]
+        state.stop = offsets[state.end()]
+        state.size = offsets[-1]
+        return state
 
     def advance(self, test_case, state):
-        return state.advance()
+        return self.__set_range(test_case, state.advance())
 
     def advance_on_success(self, test_case, state):
-        return state.advance_on_success(self.__count_instances(test_case))
+        self.local_cache = splice.line_offsets(test_case)
+        return self.__set_range(test_case, state.advance_on_success(len(self.local_cache) - 1))
 
     def transform(self, test_case, state, process_event_notifier):
-        with open(test_case) as in_file:
-            data = in_file.readlines()
-
-        old_len = len(data)
-        data = data[0 : state.index] + data[state.end() :]
-        assert len(data) < old_len
-
-        tmp = os.path.dirname(test_case)
-        with tempfile.NamedTemporaryFile(mode='w+', delete=False, dir=tmp) as tmp_file:
-            tmp_file.writelines(data)
+        assert state.start < state.stop
 
-        shutil.move(tmp_file.name, test_case)
+        splice.remove_ranges(test_case, [(state.start, state.stop)], size=state.size)
 
         return (PassResult.OK, state)
@@ -171,39 +171,74 @@ class PeepPass(AbstractPass):
         delimited_regexes_to_replace.append(([nestedmatcher.RegExPattern(r',\s*')] + x, '1'))
         delimited_regexes_to_replace.append(([nestedmatcher.RegExPattern(r',\s*')] + x, ''))
 
+    while_parts = [
+        nestedmatcher.RegExPattern(r'^while\s*'),
+        nestedmatcher.BalancedPattern(nestedmatcher.BalancedExpr.parens),
+        nestedmatcher.RegExPattern(r'\s*'),
+        (
+            nestedmatcher.BalancedPattern(nestedmatcher.BalancedExpr.curlies),
+            'body',
+        ),
+    ]
+
     def check_prerequisites(self):
         return True
 
-    def new(self, test_case, _=None):
-        return {'pos': 0, 'regex': 0}
-
-    def advance(self, test_case, state):
-        new_state = state.copy()
-
+    def __get_searches(self, prog):
         if self.arg == 'a':
-            lim = len(self.regexes_to_replace)
+            return [item[0] for item in self.regexes_to_replace]
         elif self.arg == 'b':
-            lim = len(self.delimited_regexes_to_replace)
+            if prog.startswith(','):
+                front = (self.border_or_space_optional_pattern, 'delim1')
+            else:
+                front = (self.border_or_space_pattern, 'delim1')
+
+            if prog.endswith(','):
+                back = (self.border_or_space_optional_pattern, 'delim2')
+            else:
+                back = (self.border_or_space_pattern, 'delim2')
+
+            return [[front] + item[0] + [back] for item in self.delimited_regexes_to_replace]
         elif self.arg == 'c':
-            lim = 1
+            return [self.while_parts]
         else:
             raise UnknownArgumentError(self.__class__.__name__, self.arg)
 
-        new_state['regex'] += 1
+    def __find_state(self, test_case, pos, regex):
+        """Return the first state at or after (pos, regex) where the regex matches, or None."""
+        with open(test_case) as in_file:
+            prog = in_file.read()
+
+        if self.local_cache is None or self.local_cache[0] != prog:
+            searches = self.__get_searches(prog)
+            self.local_cache = (prog, [nestedmatcher.MatchIndex(search, prog) for search in searches])
 
-        if new_state['regex'] >= lim:
-            new_state['regex'] = 0
-            new_state['pos'] += 1
+        indices = self.local_cache[1]
+        best = None
+        for i in range(regex, len(indices)):
+            p = indices[i].next_anchored(pos)
+            if p == pos:
+                return {'pos': pos, 'regex': i}
+            if p is not None and (best is None or p < best[0]):
+                best = (p, i)
 
-        with open(test_case) as in_file:
-            length = len(in_file.read())
-            if new_state['pos'] >= length:
-                return None
+        for i in range(regex):
+            p = indices[i].next_anchored(pos + 1)
+            if p is not None and (best is None or (p, i) < best):
+                best = (p, i)
+
+        if best is None:
+            return None
+        return {'pos': best[0], 'regex': best[1]}
+
+    def new(self, test_case, _=None):
+        return self.__find_state(test_case, 0, 0)
 
-        return new_state
+    def advance(self, test_case, state):
+        return self.__find_state(test_case, state['pos'], state['regex'] + 1)
 
     def advance_on_success(self, test_case, state):
-        return state
+        return self.__find_state(test_case, state['pos'], state['regex'])
 
     def transform(self, test_case, state, process_event_notifier):
         with open(test_case) as in_file:
@@ -229,21 +264,8 @@ class PeepPass(AbstractPass):
 
                     return (PassResult.OK, state)
         elif self.arg == 'b':
-            item = self.delimited_regexes_to_replace[state['regex']]
-            search = item[0]
-            replace = item[1]
-
-            if prog2.startswith(','):
-                front = (self.border_or_space_optional_pattern, 'delim1')
-            else:
-                front = (self.border_or_space_pattern, 'delim1')
-
-            if prog2.endswith(','):
-                back = (self.border_or_space_optional_pattern, 'delim2')
-            else:
-                back = (self.border_or_space_pattern, 'delim2')
-
-            search = [front] + search + [back]
+            search = self.__get_searches(prog2)[state['regex']]
+            replace = self.delimited_regexes_to_replace[state['regex']][1]
 
             m = nestedmatcher.search(search, prog2, pos=state['pos'], search=False)
 
@@ -256,15 +278,7 @@ class PeepPass(AbstractPass):
 
                     return (PassResult.OK, state)
         elif self.arg == 'c':
-            search = [
-                nestedmatcher.RegExPattern(r'^while\s*'),
-                nestedmatcher.BalancedPattern(nestedmatcher.BalancedExpr.parens),
-                nestedmatcher.RegExPattern(r'\s*'),
-                (
-                    nestedmatcher.BalancedPattern(nestedmatcher.BalancedExpr.curlies),
-                    'body',
-                ),
-            ]
+            search = self.while_parts
 
             m = nestedmatcher.search(search, prog2, pos=state['pos'], search=False)
 
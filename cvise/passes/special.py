@@ -1,6 +1,7 @@
 import re
 
 from cvise.passes.abstract import AbstractPass, PassResult
+from cvise.utils import splice
 from cvise.utils.error import UnknownArgumentError
 
 
@@ -15,44 +16,32 @@ class SpecialPass(AbstractPass):
         }
 
         def replace_printf(m):
-            return r"printf('%d\n', (int){})".format(m.group('list').split(',')[0])
+            return rb"printf('%d\n', (int)" + m.group('list').split(b',')[0] + b')'
 
         def replace_empty(m):
-            return ''
+            return b''
 
         if self.arg == 'a':
-            config['search'] = r'transparent_crc\s*\((?P<list>[^)]*)\)'
+            config['search'] = rb'transparent_crc\s*\((?P<list>[^)]*)\)'
             config['replace_fn'] = replace_printf
         elif self.arg == 'b':
-            config['search'] = r"extern 'C'"
+            config['search'] = rb"extern 'C'"
             config['replace_fn'] = replace_empty
         elif self.arg == 'c':
-            config['search'] = r"extern 'C\+\+'"
+            config['search'] = rb"extern 'C\+\+'"
             config['replace_fn'] = replace_empty
         else:
             raise UnknownArgumentError(self.__class__.__name__, self.arg)
 
         return config
 
-    def __get_next_match(self, test_case, pos):
-        with open(test_case) as in_file:
-            prog = in_file.read()
-
-        config = self.__get_config()
-        regex = re.compile(config['search'], flags=re.DOTALL)
-        m = regex.search(prog, pos=pos)
-
-        return m
-
     def new(self, test_case, _=None):
         config = self.__get_config()
-        with open(test_case) as in_file:
-            prog = in_file.read()
-            regex = re.compile(config['search'], flags=re.DOTALL)
-            modifications = list(reversed([(m.span(), config['replace_fn'](m)) for m in regex.finditer(prog)]))
-            if not modifications:
-                return None
-            return {'modifications': modifications, 'index': 0}
+        regex = re.compile(config['search'], flags=re.DOTALL)
+        modifications = splice.find_matches(test_case, regex, config['replace_fn'])
+        if not modifications:
+            return None
+        return {'modifications': list(reversed(modifications)), 'index': 0}
 
     def advance(self, test_case, state):
         state = state.copy()
@@ -65,11 +54,5 @@ class SpecialPass(AbstractPass):
         return self.new(test_case)
 
     def transform(self, test_case, state, process_event_notifier):
-        with open(test_case) as in_file:
-            data = in_file.read()
-            index = state['index']
-            ((start, end), replacement) = state['modifications'][index]
-            new_data = data[:start] + replacement + data[end:]
-            with open(test_case, 'w') as out_file:
-                out_file.write(new_data)
-                return (PassResult.OK, state)
+        splice.replace_ranges(test_case, [state['modifications'][state['index']]])
+        return (PassResult.OK, state)
@@ -29,9 +29,10 @@ class TernaryPass(AbstractPass):
         with open(test_case) as in_file:
             prog = in_file.read()
 
-        m = nestedmatcher.search(self.parts, prog, pos=pos)
+        if self.local_cache is None or self.local_cache[0] != prog:
+            self.local_cache = (prog, nestedmatcher.MatchIndex(self.parts, prog))
 
-        return m
+        return self.local_cache[1].next(pos)
 
     def new(self, test_case, _=None):
         return self.__get_next_match(test_case, pos=0)
@@ -0,0 +1,171 @@
+from array import array
+import logging
+import os
+import subprocess
+
+from cvise.passes.abstract import AbstractPass, PassResult
+from cvise.utils import splice
+from cvise.utils.error import UnknownArgumentError
+
+HASH_MODULUS = (1 << 61) - 1
+HASH_BASE = 1_000_003
+
+
+class TokensState:
+    def __init__(self, pos, index, start, end, variant):
+        # first removed token and the index of the width in the width order
+        self.pos = pos
+        self.index = index
+        # removed byte range
+        self.start = start
+        self.end = end
+        # hash of the variant
+        self.variant = variant
+
+    def __repr__(self):
+        return f'TokensState(token {self.pos}, bytes {self.start}-{self.end})'
+
+
+class Tokens:
+    """The tokens of a test case, with the hashes needed to identify the variants without building them.
+
+    The content is split at the token starts into segments, each one a token with the
+    whitespace and comments following it (the first segment is the text before the first
+    token).  Removing a run of tokens removes a run of segments, so the polynomial hash of
+    the remaining segment hashes identifies a variant no matter which test case version it
+    was derived from.
+    """
+
+    def __init__(self, data, starts):
+        self.starts = starts
+        self.size = len(data)
+
+        bounds = [0] + list(starts) + [self.size]
+        self.prefix = prefix = [0]
+        self.powers = powers = [1]
+        h = 0
+        p = 1
+        for start, end in zip(bounds, bounds[1:]):
+            h = (h * HASH_BASE + hash(data[start:end])) % HASH_MODULUS
+            p = p * HASH_BASE % HASH_MODULUS
+            prefix.append(h)
+            powers.append(p)
+
+    def __len__(self):
+        return len(self.starts)
+
+    def end(self, pos):
+        """Return the offset where token pos starts, or the file size past the last token."""
+        return self.starts[pos] if pos < len(self.starts) else self.size
+
+    def variant(self, pos, last):
+        """Return a key of the content without the tokens pos to last - 1."""
+        # the segment of token i is the segment i + 1
+        (first, last, segments) = (pos + 1, last + 1, len(self.prefix) - 1)
+        tail = segments - last
+        h = self.prefix[first] * self.powers[tail] + self.prefix[-1] - self.prefix[last] * self.powers[tail]
+        return (h % HASH_MODULUS, segments - last + first)
+
+
+class TokensPass(AbstractPass):
+    """Remove runs of 1 to arg tokens at every position.
+
+    All the widths are tried at a position before moving to the next one, the widths
+    that succeeded last first.  clex only lists the token offsets once per test case
+    version.  A variant equal to one that has already failed is skipped: e.g. once
+    removing tokens 5 and 6 failed and removing token 5 alone succeeded, removing the
+    next token at position 5 would test the same content again.  The failed variants are
+    forgotten once another test case has changed, as the test may then succeed on them.
+    """
+
+    # the number of failed variants kept before they are all forgotten
+    MAX_FAILED = 100_000
+
+    def check_prerequisites(self):
+        return self.check_external_program('clex')
+
+    def __max_width(self):
+        if not self.arg.isdigit() or int(self.arg) < 1:
+            raise UnknownArgumentError(self.__class__.__name__, self.arg)
+        return int(self.arg)
+
+    def __tokenize(self, test_case):
+        cmd = [self.external_programs['clex'], 'list-tokens', '0', test_case]
+        try:
+            proc = subprocess.run(cmd, capture_output=True)
+        except subprocess.SubprocessError as e:
+            logging.warning(f'clex list-tokens failed: {e}')
+            return None
+        if proc.returncode != 51:
+            return None
+        with open(test_case, 'rb') as f:
+            data = f.read()
+        return Tokens(data, array('q', map(int, proc.stdout.split())))
+
+    def __update_cache(self, test_case):
+        previous = self.local_cache
+        self.local_cache = {
+            'tokens': self.__tokenize(test_case),
+            # hashes of the variants tested without success
+            'failed': set() if previous is None else previous['failed'],
+            # hashes of the variants generated for the current test case version, with the
+            # position and width index of their first state
+            'generated': {},
+            'order': list(range(1, self.__max_width() + 1)) if previous is None else previous['order'],
+        }
+
+    def __find_state(self, test_case, pos, index):
+        if self.local_cache is None:
+            self.__update_cache(test_case)
+        cache = self.local_cache
+        tokens = cache['tokens']
+        if tokens is None:
+            return None
+
+        order = cache['order']
+        generated = cache['generated']
+        failed = cache['failed']
+        while pos < len(tokens):
+            while index < len(order):
+                last = min(pos + order[index], len(tokens))
+                variant = tokens.variant(pos, last)
+                # a state whose test was cancelled is enumerated again by the test manager
+                if variant not in failed and generated.setdefault(variant, (pos, index)) == (pos, index):
+                    return TokensState(pos, index, tokens.starts[pos], tokens.end(last), variant)
+                index += 1
+            pos += 1
+            index = 0
+        return None
+
+    def new(self, test_case, _=None):
+        self.local_cache = None
+        self.__update_cache(test_case)
+        return self.__find_state(test_case, 0, 0)
+
+    def advance(self, test_case, state):
+        return self.__find_state(test_case, state.pos, state.index + 1)
+
+    def advance_on_success(self, test_case, state):
+        if self.local_cache is not None:
+            # move the successful width to the front
+            order = self.local_cache['order']
+            order.insert(0, order.pop(state.index))
+        self.__update_cache(test_case)
+        return self.__find_state(test_case, state.pos, 0)
+
+    def on_failure(self, test_case, state):
+        if self.local_cache is not None:
+            failed = self.local_cache['failed']
+            if len(failed) >= self.MAX_FAILED:
+                failed.clear()
+            failed.add(state.variant)
+
+    def on_other_success(self, test_case):
+        if self.local_cache is not None:
+            self.local_cache['failed'].clear()
+
+    def transform(self, test_case, state, process_event_notifier):
+        if state.end > os.path.getsize(test_case):
+            return (PassResult.ERROR, state)
+        splice.remove_ranges(test_case, [(state.start, state.end)])
+        return (PassResult.OK, state)
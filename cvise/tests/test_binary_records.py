@@ -0,0 +1,149 @@
+import os
+import struct
+import tempfile
+import unittest
+
+from cvise.passes.abstract import PassResult
+from cvise.passes.binary import BinaryRecordsPass
+from cvise.passes.gcdabinary import GCDABinaryPass
+from cvise.utils import binaryrecords, splice
+
+
+def gcda(functions, header_words=4, unit=1):
+    """Build a little-endian GCDA profile with a summary and one counter record per function."""
+    data = b'adcg' + b'*22B' + bytes(4 * (header_words - 2))
+    data += struct.pack('<II', 0xA1000000, 8 // unit) + bytes(8)
+    for counters in functions:
+        data += struct.pack('<II', 0x01000000, 12 // unit) + bytes(12)
+        data += struct.pack('<Ii', 0x01A10000, 8 * counters // unit) + bytes(8 * counters)
+    return data + bytes(4)
+
+
+def elf(sections):
+    """Build a little-endian ELF64 relocatable from (name, data, align) sections."""
+    names = b'\0' + b''.join(name + b'\0' for name, _, _ in sections) + b'.shstrtab\0'
+    body = b''
+    headers = [bytes(64)]
+    name_offset = 1
+    for name, data, align in sections + [(b'.shstrtab', names, 1)]:
+        offset = 64 + len(body)
+        offset = (offset + align - 1) // align * align
+        body += bytes(offset - 64 - len(body)) + data
+        headers.append(struct.pack('<IIQQQQIIQQ', name_offset, 1, 0, 0, offset, len(data), 0, 0, align, 0))
+        name_offset += len(name) + 1
+    shoff = (64 + len(body) + 7) // 8 * 8
+    body += bytes(shoff - 64 - len(body))
+    header = b'\x7fELF\x02\x01\x01' + bytes(9)
+    header += struct.pack('<HHIQQQIHHHHHH', 1, 62, 1, 0, 0, shoff, 0, 64, 0, 0, 64, len(headers), len(headers) - 1)
+    return header + body + b''.join(headers)
+
+
+def bitcode_block(block_id, words):
+    # ENTER_SUBBLOCK (2 bits), block id (vbr8) and abbreviation width (vbr4), then the block length
+    return struct.pack('<II', 1 | block_id << 2 | 2 << 10, words) + bytes(4 * words)
+
+
+class BinaryRecordsTestCase(unittest.TestCase):
+    def setUp(self):
+        with tempfile.NamedTemporaryFile(delete=False) as tmp_file:
+            self.path = tmp_file.name
+
+    def tearDown(self):
+        os.unlink(self.path)
+
+    def remove(self, data, records, first, last):
+        with open(self.path, 'wb') as f:
+            f.write(data)
+        splice.splice_file(self.path, records.pieces(first, last))
+        with open(self.path, 'rb') as f:
+            return f.read()
+
+    def test_fixed(self):
+        records = binaryrecords.get_splitter('fixed-4')(b'0123456789')
+        self.assertEqual(len(records), 3)
+        self.assertEqual(self.remove(b'0123456789', records, 1, 2), b'012389')
+        self.assertEqual(self.remove(b'0123456789', records, 2, 3), b'01234567')
+        self.assertIsNone(binaryrecords.get_splitter('fixed-0'))
+
+    def test_gcda(self):
+        for header_words, unit in ((4, 1), (4, 4), (3, 4)):
+            data = gcda([1, 3, 2], header_words, unit)
+            records = binaryrecords.split_gcda(data)
+            self.assertEqual(len(records), 3)
+            variant = self.remove(data, records, 0, 2)
+            self.assertEqual(variant, gcda([2], header_words, unit))
+            self.assertEqual(len(binaryrecords.split_gcda(variant)), 1)
+
+    def test_gcda_broken(self):
+        self.assertIsNone(binaryrecords.split_gcda(gcda([1, 2])[:-12]))
+
+    def test_elf(self):
+        data = elf([(b'.text', b'\x90' * 5, 16), (b'.data', b'\x01' * 8, 8), (b'.comment', b'abc', 1)])
+        records = binaryrecords.split_elf(data)
+        self.assertEqual(len(records), 3)
+
+        variant = self.remove(data, records, 0, 1)
+        self.assertLess(len(variant), len(data))
+        records = binaryrecords.split_elf(variant)
+        self.assertEqual(len(records), 2)
+        self.assertEqual([variant[start:end] for start, end in records.ranges], [b'\x01' * 8, b'abc'])
+        # the removed section keeps its header
+        (shnum,) = struct.unpack_from('<H', variant, 0x3C)
+        self.assertEqual(shnum, 5)
+
+    def test_elf_truncated_header(self):
+        data = elf([(b'.text', b'\x90' * 5, 16)])
+        for size in (0x34, 0x3F):
+            self.assertIsNone(binaryrecords.split_elf(data[:size]))
+            # auto falls back to fixed blocks instead of failing
+            self.assertIsInstance(binaryrecords.split_auto(data[:size]), binaryrecords.FixedRecords)
+
+    def test_bitcode(self):
+        blocks = [bitcode_block(13, 2), bitcode_block(8, 5), bitcode_block(23, 1)]
+        data = b'BC\xc0\xde' + b''.join(blocks)
+        records = binaryrecords.split_bitcode(data)
+        self.assertEqual(len(records), 3)
+        self.assertEqual(self.remove(data, records, 1, 2), b'BC\xc0\xde' + blocks[0] + blocks[2])
+
+    def test_bitcode_wrapper(self):
+        bitcode = b'BC\xc0\xde' + bitcode_block(13, 2) + bitcode_block(8, 5)
+        data = struct.pack('<IIIII', 0x0B17C0DE, 0, 20, len(bitcode), 7) + bitcode + b'tail'
+        records = binaryrecords.split_auto(data)
+        self.assertEqual(len(records), 2)
+        variant = self.remove(data, records, 0, 1)
+        self.assertEqual(struct.unpack_from('<I', variant, 12)[0], len(bitcode) - 16)
+        self.assertTrue(variant.endswith(b'tail'))
+        self.assertEqual(len(binaryrecords.split_bitcode(variant)), 1)
+
+    def test_auto_fallback(self):
+        records = binaryrecords.split_auto(b'x' * 100)
+        self.assertEqual(len(records), 2)
+
+
+class BinaryRecordsPassTestCase(unittest.TestCase):
+    def test_gcda_pass(self):
+        with tempfile.NamedTemporaryFile(delete=False) as tmp_file:
+            tmp_file.write(gcda([1, 2, 3, 4]))
+
+        pass_ = GCDABinaryPass()
+        state = pass_.new(tmp_file.name)
+        self.assertEqual(state.instances, 4)
+        state = pass_.advance(tmp_file.name, state)
+        (result, state) = pass_.transform(tmp_file.name, state, None)
+        self.assertEqual(result, PassResult.OK)
+        state = pass_.advance_on_success(tmp_file.name, state)
+        self.assertEqual(state.instances, 2)
+
+        with open(tmp_file.name, 'rb') as variant_file:
+            variant = variant_file.read()
+        os.unlink(tmp_file.name)
+
+        self.assertEqual(variant, gcda([3, 4]))
+
+    def test_empty_file(self):
+        with tempfile.NamedTemporaryFile(delete=False) as tmp_file:
+            pass
+
+        state = BinaryRecordsPass('auto').new(tmp_file.name)
+        os.unlink(tmp_file.name)
+        self.assertIsNone(state)
@@ -0,0 +1,71 @@
+import unittest
+
+from cvise.passes.abstract import AdaptiveChunking, BinaryState, ProgressHistory
+
+
+class BinaryStateTestCase(unittest.TestCase):
+    def test_halving(self):
+        state = BinaryState.create(10)
+        chunks = []
+        while state:
+            chunks.append((state.index, state.chunk))
+            state = state.advance()
+
+        self.assertEqual(
+            chunks,
+            [(0, 10), (0, 5), (5, 5), (0, 2), (2, 2), (4, 2), (6, 2), (8, 2)]
+            + [(i, 1) for i in range(10)],
+        )
+
+    def test_halving_no_growth(self):
+        state = BinaryState.create(64)
+        for _ in range(3):
+            state = state.advance()
+        self.assertEqual(state.chunk, 16)
+
+        for instances in (60, 56, 52, 48):
+            state = state.advance_on_success(instances)
+        self.assertEqual((state.index, state.chunk), (0, 16))
+
+    def test_adaptive_even_chunks(self):
+        state = BinaryState.create(100, AdaptiveChunking(8))
+        chunks = []
+        while state:
+            if state.index == 0:
+                chunks.append(state.chunk)
+            state = state.advance()
+
+        self.assertEqual(chunks, [100, 50, 25, 7, 3, 1])
+
+    def test_adaptive_growth(self):
+        state = BinaryState.create(64, AdaptiveChunking(1))
+        for _ in range(4):
+            state = state.advance()
+        self.assertEqual((state.index, state.chunk), (16, 16))
+
+        state = state.advance_on_success(48)
+        state = state.advance_on_success(32)
+        self.assertEqual(state.chunk, 16)
+        state = state.advance_on_success(30)
+        self.assertEqual(state.chunk, 30)
+        self.assertEqual(state.success_streak, 0)
+
+    def test_adaptive_streak_reset(self):
+        state = BinaryState.create(64, AdaptiveChunking(1))
+        state = state.advance().advance_on_success(60)
+        state = state.advance_on_success(56)
+        self.assertEqual(state.success_streak, 2)
+        state = state.advance()
+        self.assertEqual(state.success_streak, 0)
+
+    def test_estimate_progress(self):
+        history = ProgressHistory()
+        state = BinaryState.create(10).advance()
+        estimate = state.estimate_progress(100, history)
+        self.assertEqual((estimate.probability, estimate.gain, estimate.key), (0.5, 50, 5))
+        # a failure at this chunk size makes the smaller chunks more promising
+        history.record(5, False)
+        history.record(5, False)
+        self.assertEqual(state.estimate_progress(100, history).expected_gain, 12.5)
+        smaller = BinaryState.create(10).advance().advance().advance()
+        self.assertEqual(smaller.estimate_progress(100, history).expected_gain, 10)
@@ -0,0 +1,50 @@
+from pathlib import Path
+import sys
+import tempfile
+import unittest
+
+from cvise.passes.abstract import PassResult, ProcessEventNotifier
+from cvise.passes.clang import ClangPass
+
+# crashes with the exit code given in the test case
+FAKE_CLANG_DELTA = """
+import sys
+print('Crash signature: crash in fake instance 1', file=sys.stderr)
+sys.exit(int(open(sys.argv[-1]).read()))
+"""
+
+
+class ClangPassTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        root = Path(self.tmp.name)
+        script = root / 'clang_delta'
+        script.write_text(f'#!{sys.executable}\n{FAKE_CLANG_DELTA}')
+        script.chmod(0o755)
+        self.test_case = root / 'test.c'
+        self.pass_ = ClangPass('fake', {'clang_delta': str(script)})
+        self.pass_.user_clang_delta_std = None
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def transform(self, exitcode):
+        self.test_case.write_text(str(exitcode))
+        notifier = ProcessEventNotifier(None)
+        (result, _) = self.pass_.transform(str(self.test_case), 1, notifier)
+        return (result, notifier.messages)
+
+    def test_crashed_instances(self):
+        (result, messages) = self.transform(ClangPass.CLANG_DELTA_CRASHED_INSTANCES)
+        self.assertEqual(result, PassResult.INVALID)
+        self.assertEqual(messages, ['clang_delta fake: Crash signature: crash in fake instance 1'])
+
+    def test_crashed_transformation(self):
+        (result, messages) = self.transform(ClangPass.CLANG_DELTA_CRASHED)
+        self.assertEqual(result, PassResult.ERROR)
+        self.assertEqual(len(messages), 1)
+
+    def test_invalid_counter(self):
+        (result, messages) = self.transform(1)
+        self.assertEqual(result, PassResult.STOP)
+        self.assertEqual(messages, [])
@@ -0,0 +1,128 @@
+from pathlib import Path
+import pickle
+import sys
+import tempfile
+import unittest
+
+from cvise.passes.clangpipeline import ClangPipelinePass
+
+# appends the name of every step to the test case, except for the "noop" and "fail" ones, and dies at the "crash" one
+FAKE_CLANG_DELTA = """
+import sys
+args = dict(arg[2:].split('=', 1) for arg in sys.argv[1:] if arg.startswith('--'))
+content = open(sys.argv[-1]).read()
+failed = False
+for step, name in enumerate(args['pipeline'].split(','), 1):
+    print(f'Pipeline step {step}: {name}', file=sys.stderr, flush=True)
+    if name == 'crash':
+        sys.exit(139)
+    if name == 'fail':
+        print(f'Failed pipeline step {step}: The transformation crashed!', file=sys.stderr)
+        failed = True
+    elif name != 'noop':
+        content += name + '\\n'
+        with open(f"{args['output']}.{step}", 'w') as f:
+            f.write(content)
+sys.exit(4 if failed else 0)
+"""
+
+
+class ClangPipelineTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        root = Path(self.tmp.name)
+        script = root / 'clang_delta'
+        script.write_text(f'#!{sys.executable}\n{FAKE_CLANG_DELTA}')
+        script.chmod(0o755)
+        self.test_case = root / 'test.c'
+        self.test_case.write_text('')
+        self.pass_ = ClangPipelinePass('a,noop,b,c', {'clang_delta': str(script)})
+        self.pass_.user_clang_delta_std = None
+
+    def tearDown(self):
+        if self.pass_.local_cache is not None:
+            self.pass_.local_cache.cleanup()
+        self.tmp.cleanup()
+
+    def transform(self, state):
+        self.pass_.transform(self.test_case, state, None)
+        return self.test_case.read_text().split()
+
+    def test_longest_first(self):
+        state = self.pass_.new(self.test_case)
+        variants = []
+        while state is not None:
+            variants.append(self.transform(state))
+            state = self.pass_.advance(self.test_case, state)
+        self.assertEqual(variants, [['a', 'b', 'c'], ['a', 'b'], ['a']])
+
+    def test_drop_rejected_step(self):
+        state = self.pass_.new(self.test_case)
+        # a,b,c is rejected and a,b is kept
+        state = self.pass_.advance(self.test_case, state)
+        self.transform(state)
+        # c is dropped, so nothing is left
+        self.assertIsNone(self.pass_.advance_on_success(self.test_case, state))
+
+    def test_rerun_after_rejected_step(self):
+        state = self.pass_.new(self.test_case)
+        # a,b,c and a,b are rejected, a is kept, so b goes away
+        state = self.pass_.advance(self.test_case, self.pass_.advance(self.test_case, state))
+        self.transform(state)
+        state = self.pass_.advance_on_success(self.test_case, state)
+        self.assertEqual(state.steps, ['c'])
+        self.assertEqual(self.transform(state), ['a', 'c'])
+        self.assertIsNone(self.pass_.advance(self.test_case, state))
+
+    def test_nothing_to_do(self):
+        self.pass_.arg = 'noop'
+        self.assertIsNone(self.pass_.new(self.test_case))
+
+    def test_crash(self):
+        self.pass_.arg = 'a,crash,b'
+        state = self.pass_.new(self.test_case)
+        self.assertEqual(self.transform(state), ['a'])
+        self.assertIsNone(self.pass_.advance(self.test_case, state))
+        # the crashed step is dropped, the steps after it are run
+        state = self.pass_.advance_on_success(self.test_case, state)
+        self.assertEqual(state.steps, ['b'])
+        self.assertEqual(self.transform(state), ['a', 'b'])
+
+    def test_crash_without_output(self):
+        self.pass_.arg = 'noop,crash,a'
+        state = self.pass_.new(self.test_case)
+        # the pipeline goes on with the steps after the crashed one
+        self.assertEqual(state.steps, ['a'])
+        self.assertEqual(self.transform(state), ['a'])
+
+    def test_crash_after_noop(self):
+        self.pass_.arg = 'a,noop,crash,b'
+        state = self.pass_.new(self.test_case)
+        self.assertEqual(self.transform(state), ['a'])
+        # the reported step is dropped, not the one after the last output
+        state = self.pass_.advance_on_success(self.test_case, state)
+        self.assertEqual(state.steps, ['b'])
+        self.assertEqual(self.transform(state), ['a', 'b'])
+
+    def test_failed_step(self):
+        self.pass_.arg = 'a,fail,b'
+        state = self.pass_.new(self.test_case)
+        self.assertEqual(state.failed, {2})
+        self.assertEqual(self.transform(state), ['a', 'b'])
+        state = self.pass_.advance(self.test_case, state)
+        self.assertEqual(self.transform(state), ['a'])
+        # b is to blame, and the failed step is not run again
+        self.assertIsNone(self.pass_.advance_on_success(self.test_case, state))
+
+    def test_failed_step_not_rerun(self):
+        self.pass_.arg = 'a,b,fail,c'
+        state = self.pass_.new(self.test_case)
+        state = self.pass_.advance(self.test_case, self.pass_.advance(self.test_case, state))
+        self.assertEqual(self.transform(state), ['a'])
+        state = self.pass_.advance_on_success(self.test_case, state)
+        self.assertEqual(state.steps, ['c'])
+
+    def test_outputs_not_in_state(self):
+        state = self.pass_.new(self.test_case)
+        self.assertEqual(state.outputs, [4, 3, 1])
+        self.assertLess(len(pickle.dumps(state)), 1000)
@@ -0,0 +1,49 @@
+import os
+import shutil
+import tempfile
+import unittest
+
+from cvise.passes.abstract import ProcessEventNotifier
+from cvise.passes.clex import ClexPass
+
+# clex is built next to the cvise directory of the build tree
+CLEX = shutil.which('clex', path=os.path.join(os.path.dirname(__file__), '..', '..', 'clex')) or shutil.which('clex')
+
+
+@unittest.skipIf(CLEX is None, 'clex is not built')
+class RmTokPatternTestCase(unittest.TestCase):
+    def setUp(self):
+        self.pass_ = ClexPass('rm-tok-pattern-4', external_programs={'clex': CLEX})
+        self.process_event_notifier = ProcessEventNotifier(None)
+
+    def variants(self, content):
+        """Return the variants of all the listed instances, with the tokens separated by single spaces."""
+        variants = set()
+        with tempfile.TemporaryDirectory() as tmp:
+            test_case = os.path.join(tmp, 'test.cc')
+            with open(test_case, 'w') as f:
+                f.write(content)
+            state = self.pass_.new(test_case)
+            while state is not None:
+                variant = os.path.join(tmp, 'variant.cc')
+                shutil.copy(test_case, variant)
+                self.pass_.transform(variant, state, self.process_event_notifier)
+                with open(variant) as f:
+                    variants.add(' '.join(f.read().split()))
+                state = self.pass_.advance(test_case, state)
+        return variants
+
+    def test_unbalanced(self):
+        self.assertNotIn('int a [ 2 ;', self.variants('int a [ 2 ] ;'))
+
+    def test_dangling_operator(self):
+        self.assertNotIn('int a = ;', self.variants('int a = 2 ;'))
+
+    def test_lambda_capture_default(self):
+        self.assertIn('auto f = [ = ] { } ;', self.variants('auto f = [ = , & x ] { } ;'))
+        self.assertIn('auto f = [ = , & y ] { } ;', self.variants('auto f = [ = , & x , & y ] { } ;'))
+
+    def test_operator_name(self):
+        self.assertIn('using B :: operator = ;', self.variants('using B :: operator = , B :: f ;'))
+        self.assertIn('f ( & S :: operator == ) ;', self.variants('f ( & S :: operator == , g ) ;'))
+        self.assertIn('using B :: operator << ;', self.variants('using B :: operator << , B :: f ;'))
@@ -0,0 +1,47 @@
+from array import array
+import os
+import tempfile
+import unittest
+
+from cvise.passes.abstract import PassResult
+from cvise.passes.lines import LinesPass
+
+
+class LinesTestCase(unittest.TestCase):
+    def setUp(self):
+        self.pass_ = LinesPass('None')
+
+    def test_remove_lines(self):
+        with tempfile.NamedTemporaryFile(mode='w', delete=False) as tmp_file:
+            tmp_file.write('int a;\nint b;\nint c;\nint d;')
+
+        state = self.pass_.new(tmp_file.name)
+        self.assertEqual(state.instances, 4)
+        state = self.pass_.advance(tmp_file.name, state)
+        state = self.pass_.advance(tmp_file.name, state)
+        (result, state) = self.pass_.transform(tmp_file.name, state, None)
+        self.assertEqual(result, PassResult.OK)
+
+        with open(tmp_file.name) as variant_file:
+            variant = variant_file.read()
+        self.assertEqual(variant, 'int a;\nint b;\n')
+
+        state = self.pass_.advance_on_success(tmp_file.name, state)
+        os.unlink(tmp_file.name)
+        self.assertEqual(state.instances, 2)
+        self.assertEqual((state.start, state.stop, state.size), (0, 7, 14))
+        # only the byte range is sent to the workers
+        self.assertFalse(any(isinstance(v, array) for v in vars(state).values()))
+
+    def test_crlf(self):
+        with tempfile.NamedTemporaryFile(mode='wb', delete=False) as tmp_file:
+            tmp_file.write(b'int a;\r\nint b;\rint c;\r\n')
+
+        state = self.pass_.new(tmp_file.name)
+        # a lone \r does not end a line
+        self.assertEqual(state.instances, 2)
+        (result, state) = self.pass_.transform(tmp_file.name, self.pass_.advance(tmp_file.name, state), None)
+        with open(tmp_file.name, 'rb') as variant_file:
+            variant = variant_file.read()
+        os.unlink(tmp_file.name)
+        self.assertEqual(variant, b'int b;\rint c;\r\n')
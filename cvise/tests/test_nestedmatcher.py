@@ -1,9 +1,13 @@
+import pickle
 import unittest
 
+from cvise.passes.balanced import BalancedPass
 from cvise.utils.nestedmatcher import (
     BalancedExpr,
     BalancedPattern,
+    BracketPairs,
     find,
+    MatchIndex,
     OrPattern,
     RegExPattern,
     search,
@@ -117,3 +121,42 @@ class ComplexParensTest(unittest.TestCase):
         ]
         m = search(parts, '(This string this (contains)) two (nested) matches!')
         self.assertEqual(m, {'all': (13, 33), 'nested': (18, 28), 'nested2': (30, 33)})
+
+
+class BracketPairsTest(unittest.TestCase):
+    def test_unbalanced(self):
+        pairs = BracketPairs('(', ')', ')((a) (b)')
+        self.assertEqual(pairs.starts, [2, 6])
+        self.assertIsNone(pairs.match(1))
+        self.assertEqual(pairs.match(2), (2, 5))
+        self.assertEqual(pairs.search(3), (6, 9))
+        self.assertIsNone(pairs.search(7))
+
+
+class MatchIndexTest(unittest.TestCase):
+    def test_next(self):
+        string = 'f(a) g (b) h'
+        index = MatchIndex([RegExPattern(r'[a-z]\s*'), BalancedPattern(BalancedExpr.parens)], string)
+        self.assertEqual(index.next(0)['all'], (0, 4))
+        self.assertEqual(index.next(1)['all'], (5, 10))
+        self.assertEqual(index.next(5)['all'], (5, 10))
+        self.assertIsNone(index.next(6))
+        # going backwards restarts the scan
+        self.assertEqual(index.next(0)['all'], (0, 4))
+
+    def test_next_anchored(self):
+        parts = [RegExPattern(r'[ (]'), RegExPattern('x')]
+        string = 'a  x (x'
+        index = MatchIndex(parts, string)
+        for pos in range(len(string)):
+            expected = None
+            for p in range(pos, len(string)):
+                if search(parts, string, pos=p, search=False):
+                    expected = p
+                    break
+            self.assertEqual(index.next_anchored(pos), expected)
+
+    def test_pass_cache_not_pickled(self):
+        pass_ = BalancedPass('parens')
+        pass_.local_cache = ('()', None)
+        self.assertIsNone(pickle.loads(pickle.dumps(pass_)).local_cache)
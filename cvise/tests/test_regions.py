@@ -0,0 +1,51 @@
+import unittest
+
+from cvise.utils.regions import FocusRegions, common_prefix, common_suffix
+
+
+class RegionsTestCase(unittest.TestCase):
+    def test_common(self):
+        self.assertEqual(common_prefix(b'abcd', b'abxd'), 2)
+        self.assertEqual(common_prefix(b'abc', b'abc'), 3)
+        self.assertEqual(common_suffix(b'abcd', b'abxd', 2), 1)
+        # the suffix doesn't overlap the prefix
+        self.assertEqual(common_suffix(b'aa', b'aaa', 0), 0)
+
+    def test_parse(self):
+        regions = FocusRegions.parse(['10:5', '0:3'])
+        self.assertEqual(regions.regions, [(0, 3), (10, 15)])
+        self.assertEqual(regions.clang_delta_args(), ['--region=0:3', '--region=10:5'])
+        with self.assertRaises(ValueError):
+            FocusRegions.parse(['10'])
+        with self.assertRaises(ValueError):
+            FocusRegions.parse(['a:5'])
+
+    def test_update_before_and_after(self):
+        regions = FocusRegions([(4, 8)])
+        regions.update(b'xxa bbbb c', b'a bbbb c')
+        self.assertEqual(regions.regions, [(2, 6)])
+        regions.update(b'a bbbb c', b'a bbbb cyy')
+        self.assertEqual(regions.regions, [(2, 6)])
+
+    def test_update_two_changes(self):
+        regions = FocusRegions([(4, 8)])
+        # everything between the first and the last change is taken as changed
+        regions.update(b'xxa bbbb cyy', b'a bbbb c')
+        self.assertEqual(regions.regions, [(0, 8)])
+
+    def test_update_inside(self):
+        regions = FocusRegions([(2, 8)])
+        regions.update(b'a bbbbbb c', b'a bb c')
+        self.assertEqual(regions.regions, [(2, 4)])
+
+    def test_update_overlapping(self):
+        regions = FocusRegions([(2, 6), (8, 10)])
+        # the change starts before the first region and ends in it
+        regions.update(b'a bbbb cc d', b'abb cc d')
+        self.assertEqual(regions.regions, [(1, 3), (5, 7)])
+
+    def test_update_removed(self):
+        regions = FocusRegions([(2, 4)])
+        regions.update(b'a bb c', b'a c')
+        self.assertEqual(regions.regions, [])
+        self.assertEqual(regions.clang_delta_args(), ['--region=0:0'])
@@ -0,0 +1,56 @@
+import os
+import re
+import tempfile
+import unittest
+
+from cvise.utils import splice
+
+
+class SpliceTestCase(unittest.TestCase):
+    def setUp(self):
+        with tempfile.NamedTemporaryFile(mode='wb', delete=False) as tmp_file:
+            tmp_file.write(b'first\n  # 1 "a.h"\n\xff\xfe binary\n# 2 "b.h"\nlast')
+        self.path = tmp_file.name
+
+    def tearDown(self):
+        os.unlink(self.path)
+
+    def read(self):
+        with open(self.path, 'rb') as f:
+            return f.read()
+
+    def test_line_offsets(self):
+        self.assertEqual(list(splice.line_offsets(self.path)), [0, 6, 18, 28, 38, 42])
+
+    def test_line_ranges(self):
+        regex = re.compile(rb'^[^\S\n]*#[^\S\n]*[0-9]+', flags=re.MULTILINE)
+        self.assertEqual(splice.line_ranges(self.path, regex), [(6, 18), (28, 38)])
+
+    def test_remove_ranges(self):
+        splice.remove_ranges(self.path, [(0, 6), (28, 38)])
+        self.assertEqual(self.read(), b'  # 1 "a.h"\n\xff\xfe binary\nlast')
+
+    def test_splice_file(self):
+        splice.splice_file(self.path, [(38, 42), b' and ', (0, 5)])
+        self.assertEqual(self.read(), b'last and first')
+
+    def test_find_matches(self):
+        edits = splice.find_matches(self.path, re.compile(rb'"(.)\.h"'), lambda m: m.group(1).upper())
+        self.assertEqual(edits, [(12, 17, b'A'), (32, 37, b'B')])
+        splice.replace_ranges(self.path, edits)
+        self.assertEqual(self.read(), b'first\n  # 1 A\n\xff\xfe binary\n# 2 B\nlast')
+
+    def test_many_pieces(self):
+        # more pieces than a single vectored write takes
+        count = 3 * splice.IOV_MAX + 7
+        splice.splice_file(self.path, [(i % 5, i % 5 + 1) for i in range(count)])
+        self.assertEqual(self.read(), (b'first' * count)[:count])
+
+    def test_blank_line_at_end(self):
+        regex = re.compile(rb'^[^\S\n]*$', flags=re.MULTILINE)
+        self.assertEqual(splice.line_ranges(self.path, regex), [])
+
+    def test_empty_file(self):
+        open(self.path, 'wb').close()
+        self.assertEqual(list(splice.line_offsets(self.path)), [0])
+        self.assertEqual(splice.line_ranges(self.path, re.compile(b'^#', flags=re.MULTILINE)), [])
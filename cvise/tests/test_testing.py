@@ -0,0 +1,255 @@
+import os
+from pathlib import Path
+import tempfile
+import unittest
+from unittest import mock
+
+from cvise.passes.abstract import BinaryState
+from cvise.utils.statistics import PassStatistic
+from cvise.passes.lines import LinesPass
+from cvise.passes.tokens import TokensPass
+from cvise.tests.test_tokens import list_tokens
+from cvise.utils import statistics, testing
+
+
+class TestEnvironmentTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.root = Path(self.tmp.name)
+        self.cwd = os.getcwd()
+        os.chdir(self.root)
+        Path('test.c').write_text('int x;\n')
+        (self.root / 'work').mkdir()
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        self.tmp.cleanup()
+
+    def create_script(self, name, exitcode):
+        script = self.root / name
+        script.write_text(f'#!/bin/sh\necho {name} >> log\nexit {exitcode}\n')
+        script.chmod(0o755)
+        return script
+
+    def create_env(self, fast_test_script):
+        test_script = self.create_script('full.sh', 0)
+        test_case = Path('test.c')
+        return testing.TestEnvironment(
+            None, 0, test_script, self.root / 'work', test_case, [test_case], None, None, fast_test_script
+        )
+
+    def read_log(self):
+        return (self.root / 'work' / 'log').read_text().split()
+
+    def test_no_fast_test(self):
+        test_env = self.create_env(None)
+        self.assertEqual(test_env.run_test(False), 0)
+        self.assertEqual(self.read_log(), ['full.sh'])
+        self.assertIsNone(test_env.fast_exitcode)
+        self.assertIsNone(test_env.fast_seconds)
+        self.assertIsNotNone(test_env.test_seconds)
+
+    def test_fast_test_accepts(self):
+        test_env = self.create_env(self.create_script('fast.sh', 0))
+        self.assertEqual(test_env.run_test(False), 0)
+        self.assertEqual(self.read_log(), ['fast.sh', 'full.sh'])
+        self.assertEqual(test_env.fast_exitcode, 0)
+
+    def test_fast_test_rejects(self):
+        test_env = self.create_env(self.create_script('fast.sh', 3))
+        self.assertEqual(test_env.run_test(False), 3)
+        # the full test is never run
+        self.assertEqual(self.read_log(), ['fast.sh'])
+        self.assertIsNone(test_env.test_seconds)
+
+    def test_statistic(self):
+        statistic = statistics.TestStatistic()
+        accepted = self.create_env(self.create_script('fast.sh', 0))
+        accepted.exitcode = accepted.run_test(False)
+        statistic.add(accepted)
+        rejected = self.create_env(self.create_script('fast.sh', 1))
+        rejected.exitcode = rejected.run_test(False)
+        statistic.add(rejected)
+        self.assertEqual((statistic.fast.executed, statistic.fast.passed), (2, 1))
+        self.assertEqual((statistic.full.executed, statistic.full.passed), (1, 1))
+
+
+class PassJobTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.test_case = Path(self.tmp.name) / 'test.c'
+        self.test_case.write_text(('x' * 24 + '\n') * 4)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_fill_pending(self):
+        job = testing.PassJob(LinesPass('0'), self.test_case)
+        job.state = BinaryState.create(4)
+        job.fill_pending(3)
+        self.assertEqual([p.state.chunk for p in job.pending], [4, 2, 2])
+        self.assertEqual([p.seq for p in job.pending], [0, 1, 2])
+
+    def test_pick_highest_expected_gain(self):
+        job = testing.PassJob(LinesPass('0'), self.test_case)
+        job.state = BinaryState.create(4)
+        for _ in range(3):
+            job.history.record(4, False)
+        job.fill_pending(3)
+        # the whole test case is unlikely to go, a half of it is tried first
+        self.assertEqual(testing.TestManager.pick_pending_state([job], 0), (job, 1))
+
+    def test_no_estimates(self):
+        pass_ = LinesPass('0')
+        pass_.estimate_progress = lambda test_case, state, history: None
+        job = testing.PassJob(pass_, self.test_case)
+        job.state = BinaryState.create(4)
+        job.fill_pending(3)
+        self.assertEqual(len(job.pending), 1)
+
+
+class FileStatsTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.test_case = Path(self.tmp.name) / 'test.c'
+        # only the file statistics are used
+        self.manager = testing.TestManager.__new__(testing.TestManager)
+        self.manager.test_cases = {self.test_case}
+        self.manager.file_sizes = {}
+        self.manager.line_counts = {}
+        self.manager.undecodable_lines = {}
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def change(self, before, after):
+        self.test_case.write_bytes(before)
+        self.manager.update_file_stats(self.test_case)
+        self.test_case.write_bytes(after)
+        self.manager.update_file_stats(self.test_case, before, after)
+        # the same as counting the new content from scratch
+        self.assertEqual(self.manager.file_sizes[self.test_case], len(after))
+        self.assertEqual(self.manager.total_line_count, testing.TestManager.get_line_count([self.test_case]))
+
+    def test_count_lines(self):
+        self.assertEqual(testing.TestManager.count_lines(b'a\n \n\tb\n\xff\n'), (3, 1))
+
+    def test_update(self):
+        self.change(b'int a;\nint b;\n\nint c;\n', b'int a;\nint c;\n')
+        self.change(b'int a;\nint b;\n', b'int a;\nint b;\n\n  \nint b;\n')
+        self.change(b'a\nb', b'a\n')
+        self.change(b'a b\n', b'a\n b\n')
+        self.change(b'a\n', b'a\n')
+
+    def test_update_undecodable(self):
+        self.change(b'a\n\xff\nb\n', b'a\nb\n')
+        self.assertEqual(self.manager.total_line_count, 2)
+        self.change(b'a\nb\n', b'a\n\xc3\nb\n')
+        self.assertEqual(self.manager.total_line_count, 0)
+
+
+class FakeTestManager:
+    TEMP_PREFIX = 'cvise-test-'
+
+    def check_sanity(self, contents=None):
+        pass
+
+    def matches_snapshot(self, snapshot):
+        return True
+
+
+@mock.patch('cvise.passes.tokens.subprocess.run', list_tokens)
+class PrefetchTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.cwd = os.getcwd()
+        os.chdir(self.tmp.name)
+
+    def tearDown(self):
+        os.chdir(self.cwd)
+        self.tmp.cleanup()
+
+    def test_local_cache_per_test_case(self):
+        manager = FakeTestManager()
+        snapshot = {Path('a.c'): b'a b c d e f', Path('b.c'): b'x y'}
+        for test_case, data in snapshot.items():
+            test_case.write_bytes(data)
+        pass_ = TokensPass('1', external_programs={'clex': 'clex'})
+        states = testing.TestManager.create_speculative_states(manager, pass_, snapshot)
+
+        for test_case, data in snapshot.items():
+            job = testing.PassJob(pass_, test_case)
+            state = testing.TestManager.create_state(manager, job, (snapshot, states))
+            # the job advances with the tokens of its own test case
+            self.assertEqual(job.pass_.local_cache['tokens'].size, len(data))
+            ends = []
+            while state is not None:
+                ends.append(state.end)
+                state = job.pass_.advance(test_case, state)
+            self.assertEqual(ends[-1], len(data))
+            self.assertEqual(len(ends), len(data.split()))
+
+
+class UnestimatedLinesPass(LinesPass):
+    # the states are tested in the order of advance, taking turns between the jobs
+    def estimate_progress(self, test_case, state, history):
+        return None
+
+
+class RunParallelTestsTestCase(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.cwd = os.getcwd()
+        os.chdir(self.tmp.name)
+        Path('a.c').write_text('int a;\nint b;\n')
+        Path('b.c').write_text('int c;\nint d;\n')
+        # the variants of a.c succeed at once, the ones of b.c fail after a while
+        script = Path('test.sh')
+        script.write_text('#!/bin/sh\ngrep -q d b.c && exit 0\nsleep 1\nexit 1\n')
+        script.chmod(0o755)
+        self.manager = testing.TestManager(
+            PassStatistic(),
+            script,
+            timeout=10,
+            save_temps=False,
+            test_cases=['a.c', 'b.c'],
+            parallel_tests=2,
+            no_cache=True,
+            skip_key_off=True,
+            silent_pass_bug=True,
+            die_on_pass_bug=False,
+            print_diff=False,
+            max_improvement=None,
+            no_give_up=False,
+            also_interesting=None,
+            start_with_pass=None,
+            skip_after_n_transforms=None,
+            stopping_threshold=1,
+        )
+        self.manager.create_root()
+        self.manager.futures = []
+        self.manager.temporary_folders = {}
+        self.manager.reported_messages = set()
+        self.manager.pid_queue = None
+
+    def tearDown(self):
+        self.manager.remove_root()
+        os.chdir(self.cwd)
+        self.tmp.cleanup()
+
+    def create_job(self, test_case):
+        pass_ = UnestimatedLinesPass('None')
+        pass_.max_transforms = None
+        job = testing.PassJob(pass_, Path(test_case))
+        job.state = job.pass_.new(job.test_case)
+        return job
+
+    def test_rewind_other_job(self):
+        jobs = [self.create_job('a.c'), self.create_job('b.c')]
+        self.manager.current_pass = jobs[0].pass_
+        self.manager.pass_statistic.start(self.manager.current_pass)
+        self.manager.jobs = {job.test_case: job for job in jobs}
+        success = self.manager.run_parallel_tests(jobs)
+        self.assertEqual(success.test_case, Path('a.c'))
+        # the test of the first state of b.c was cancelled, it gets tested later
+        self.assertEqual([pending.seq for pending in jobs[1].pending], [0])
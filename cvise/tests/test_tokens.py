@@ -0,0 +1,130 @@
+import os
+import re
+import subprocess
+import tempfile
+import unittest
+from unittest import mock
+
+from cvise.passes.abstract import PassResult
+from cvise.passes.tokens import Tokens, TokensPass
+
+
+def list_tokens(cmd, **kwargs):
+    """Stand-in for clex list-tokens that treats every word as a token."""
+    with open(cmd[-1], 'rb') as f:
+        offsets = [m.start() for m in re.finditer(rb'\S+', f.read())]
+    return subprocess.CompletedProcess(cmd, 51, ''.join(f'{o}\n' for o in offsets).encode(), b'')
+
+
+def tokens(data):
+    return Tokens(data, [m.start() for m in re.finditer(rb'\S+', data)])
+
+
+class TokensTestCase(unittest.TestCase):
+    def test_variant(self):
+        t = tokens(b' a b c d ')
+        self.assertEqual(t.end(1), 3)
+        self.assertEqual(t.end(4), 9)
+        self.assertEqual(t.variant(1, 3), tokens(b' a d ').variant(0, 0))
+        self.assertEqual(t.variant(0, 1), t.variant(0, 1))
+        self.assertNotEqual(t.variant(0, 1), t.variant(1, 2))
+
+    def test_variant_across_versions(self):
+        # removing b from the version without a is removing a and b from the original
+        self.assertEqual(tokens(b'a b c').variant(0, 2), tokens(b'b c').variant(0, 1))
+
+
+@mock.patch('cvise.passes.tokens.subprocess.run', list_tokens)
+class TokensPassTestCase(unittest.TestCase):
+    def setUp(self):
+        self.pass_ = TokensPass('2', external_programs={'clex': 'clex'})
+
+    def write(self, content):
+        with tempfile.NamedTemporaryFile(mode='w', delete=False) as tmp_file:
+            tmp_file.write(content)
+        self.addCleanup(os.unlink, tmp_file.name)
+        return tmp_file.name
+
+    def read(self, path):
+        with open(path) as f:
+            return f.read()
+
+    def test_widths(self):
+        path = self.write('a b c')
+        state = self.pass_.new(path)
+        ranges = []
+        while state is not None:
+            ranges.append((state.start, state.end))
+            state = self.pass_.advance(path, state)
+        # removing 2 tokens at the last position is the same as removing 1
+        self.assertEqual(ranges, [(0, 2), (0, 4), (2, 4), (2, 5), (4, 5)])
+
+    def test_success(self):
+        path = self.write('a b c d e')
+        state = self.pass_.new(path)
+        self.pass_.on_failure(path, state)
+        state = self.pass_.advance(path, state)
+        (result, state) = self.pass_.transform(path, state, None)
+        self.assertEqual(result, PassResult.OK)
+        self.assertEqual(self.read(path), 'c d e')
+
+        state = self.pass_.advance_on_success(path, state)
+        # the width of 2 is tried first now
+        self.assertEqual((state.start, state.end), (0, 4))
+        self.pass_.on_failure(path, state)
+        state = self.pass_.advance(path, state)
+        self.assertEqual((state.start, state.end), (0, 2))
+        self.pass_.transform(path, state, None)
+        self.assertEqual(self.read(path), 'd e')
+
+        state = self.pass_.advance_on_success(path, state)
+        # removing d gives 'e', which has failed when c and d were removed together
+        self.assertEqual((state.start, state.end), (0, 3))
+
+    def test_untested_variant(self):
+        path = self.write('a b c d e')
+        state = self.pass_.new(path)
+        # the test of the first variant was cancelled by the success of the second one
+        state = self.pass_.advance(path, state)
+        self.pass_.transform(path, state, None)
+        self.assertEqual(self.read(path), 'c d e')
+
+        state = self.pass_.advance_on_success(path, state)
+        state = self.pass_.advance(path, state)
+        self.pass_.transform(path, state, None)
+        self.assertEqual(self.read(path), 'd e')
+
+        state = self.pass_.advance_on_success(path, state)
+        # removing d gives 'e', which has not been tested yet
+        self.assertEqual((state.start, state.end), (0, 2))
+
+    def test_other_test_case_changed(self):
+        path = self.write('a b c d e')
+        state = self.pass_.new(path)
+        self.pass_.on_failure(path, state)
+        state = self.pass_.advance(path, state)
+        self.pass_.transform(path, state, None)
+
+        state = self.pass_.advance_on_success(path, state)
+        self.pass_.on_failure(path, state)
+        self.pass_.on_other_success(path)
+        state = self.pass_.advance(path, state)
+        self.pass_.transform(path, state, None)
+        self.assertEqual(self.read(path), 'd e')
+
+        state = self.pass_.advance_on_success(path, state)
+        # 'e' failed before another test case changed, so it is tested again
+        self.assertEqual((state.start, state.end), (0, 2))
+
+    def test_failed_limit(self):
+        path = self.write('a b c d e')
+        self.pass_.MAX_FAILED = 2
+        state = self.pass_.new(path)
+        for _ in range(3):
+            self.pass_.on_failure(path, state)
+            state = self.pass_.advance(path, state)
+        self.assertEqual(len(self.pass_.local_cache['failed']), 1)
+
+    def test_no_tokens(self):
+        path = self.write(' ')
+        self.assertIsNone(self.pass_.new(path))
@@ -0,0 +1,328 @@
+"""Split binary test cases into records that can be removed independently.
+
+A splitter takes the content of a file (bytes or a memory mapping) and returns a
+Records object, or None if the content is not in its format.  Records.pieces()
+describes a variant with a contiguous run of records removed, in the form
+accepted by splice.splice_file: byte ranges of the original content and bytes
+objects for the headers that have to be patched.
+"""
+
+import re
+import struct
+
+
+class Records:
+    def __init__(self, ranges, size):
+        # sorted, non-overlapping (start, end) byte ranges
+        self.ranges = ranges
+        self.size = size
+
+    def __len__(self):
+        return len(self.ranges)
+
+    def pieces(self, first, last):
+        """Return the pieces of the content without the records first to last - 1."""
+        return _remove_ranges(self.ranges[first:last], 0, self.size)
+
+
+def _remove_ranges(ranges, start, end):
+    pieces = []
+    for range_start, range_end in ranges:
+        pieces.append((start, range_start))
+        start = range_end
+    pieces.append((start, end))
+    return pieces
+
+
+class FixedRecords(Records):
+    """Blocks of a fixed number of bytes, the last one may be shorter."""
+
+    def __init__(self, size, block):
+        self.size = size
+        self.block = block
+
+    def __len__(self):
+        return (self.size + self.block - 1) // self.block
+
+    def pieces(self, first, last):
+        return [(0, first * self.block), (min(last * self.block, self.size), self.size)]
+
+
+def split_fixed(data, block):
+    if not len(data):
+        return None
+    return FixedRecords(len(data), block)
+
+
+GCDA_TAG_FUNCTION = 0x01000000
+
+
+def _gcda_records(data, fmt, header_words, unit):
+    """Return the (tag, offset) of all records and the end of the record chain, or None if the chain is broken."""
+    pos = header_words * 4
+    records = []
+    while pos + 8 <= len(data):
+        (tag, length) = struct.unpack_from(fmt, data, pos)
+        if not tag:
+            break
+        if tag & 0xFFFF:
+            return None
+        # GCC 12+ stores the counters that are all zero as a negative length without payload
+        end = pos + 8 + max(length, 0) * unit
+        if end > len(data):
+            return None
+        records.append((tag, pos))
+        pos = end
+    # the chain may be terminated by a zero word
+    if any(data[pos:]) or len(data) - pos > 4:
+        return None
+    return (records, pos)
+
+
+def split_gcda(data):
+    """Split a GCDA profile into functions, each with the counters that follow it.
+
+    The header has 3 words before GCC 12 and 4 words (with a checksum) since;
+    record lengths are counted in words before GCC 13 and in bytes since.  The
+    variant is detected by checking that the record chain ends exactly at the
+    end of the file (or at its terminating zero word).
+    """
+    magic = bytes(data[:4])
+    if magic == b'adcg':
+        fmt = '<Ii'
+    elif magic == b'gcda':
+        fmt = '>Ii'
+    else:
+        return None
+
+    for header_words, unit in ((4, 1), (4, 4), (3, 4)):
+        chain = _gcda_records(data, fmt, header_words, unit)
+        if chain is not None:
+            break
+    else:
+        return None
+
+    (records, end) = chain
+    functions = [pos for tag, pos in records if tag == GCDA_TAG_FUNCTION]
+    if not functions:
+        return None
+    return Records(list(zip(functions, functions[1:] + [end])), len(data))
+
+
+ELF_MAGIC = b'\x7fELF'
+SHT_NULL = 0
+SHT_NOBITS = 8
+
+
+class ElfRecords(Records):
+    """Sections of a relocatable ELF object; the file layout is rebuilt for every variant."""
+
+    def __init__(self, data, endian, is64, header, sections, shstrndx):
+        self.endian = endian
+        self.is64 = is64
+        self.header = header
+        # (index, offset, size, align, type, raw header) in file order
+        self.sections = sections
+        self.removable = [s for s in sections if s[0] != shstrndx and s[4] != SHT_NOBITS and s[2]]
+        super().__init__([(s[1], s[1] + s[2]) for s in self.removable], len(data))
+
+    def pieces(self, first, last):
+        removed = {s[0] for s in self.removable[first:last]}
+        shdr_fmt = self.endian + ('IIQQQQIIQQ' if self.is64 else 'IIIIIIIIII')
+
+        pieces = [None]
+        pos = len(self.header)
+        headers = {}
+        for index, offset, size, align, sh_type, raw in self.sections:
+            if sh_type == SHT_NULL:
+                headers[index] = raw
+                continue
+            fields = list(struct.unpack(shdr_fmt, raw))
+            if index in removed or sh_type == SHT_NOBITS or not size:
+                fields[4] = pos
+                if index in removed:
+                    fields[5] = 0
+            else:
+                aligned = (pos + align - 1) // align * align if align > 1 else pos
+                if aligned > pos:
+                    pieces.append(b'\0' * (aligned - pos))
+                pieces.append((offset, offset + size))
+                fields[4] = aligned
+                pos = aligned + size
+            headers[index] = struct.pack(shdr_fmt, *fields)
+
+        word = 8 if self.is64 else 4
+        shoff = (pos + word - 1) // word * word
+        if shoff > pos:
+            pieces.append(b'\0' * (shoff - pos))
+        pieces.append(b''.join(headers[i] for i in range(len(headers))))
+
+        header = bytearray(self.header)
+        if self.is64:
+            struct.pack_into(self.endian + 'Q', header, 0x28, shoff)
+        else:
+            struct.pack_into(self.endian + 'I', header, 0x20, shoff)
+        pieces[0] = bytes(header)
+        return pieces
+
+
+def split_elf(data):
+    """Split an ELF object without program headers (a relocatable) into its sections.
+
+    The section header string table is kept; removed sections keep their
+    headers with a zero size, so section indices stay valid.
+    """
+    if bytes(data[:4]) != ELF_MAGIC or len(data) < 6:
+        return None
+    if data[4] not in (1, 2) or data[5] not in (1, 2):
+        return None
+    is64 = data[4] == 2
+    # the ELF header ends at 0x34 (ELF32) or 0x40 (ELF64)
+    if len(data) < (0x40 if is64 else 0x34):
+        return None
+    endian = '<' if data[5] == 1 else '>'
+
+    if is64:
+        (shoff,) = struct.unpack_from(endian + 'Q', data, 0x28)
+        (ehsize, _, phnum, shentsize, shnum, shstrndx) = struct.unpack_from(endian + 'HHHHHH', data, 0x34)
+        shdr_fmt = endian + 'IIQQQQIIQQ'
+    else:
+        (shoff,) = struct.unpack_from(endian + 'I', data, 0x20)
+        (ehsize, _, phnum, shentsize, shnum, shstrndx) = struct.unpack_from(endian + 'HHHHHH', data, 0x28)
+        shdr_fmt = endian + 'IIIIIIIIII'
+
+    if phnum or not shnum or shentsize != struct.calcsize(shdr_fmt) or shoff + shnum * shentsize > len(data):
+        return None
+
+    sections = []
+    for index in range(shnum):
+        raw = bytes(data[shoff + index * shentsize : shoff + (index + 1) * shentsize])
+        fields = struct.unpack(shdr_fmt, raw)
+        (sh_type, offset, size, align) = (fields[1], fields[4], fields[5], fields[8])
+        if index == 0 and sh_type == SHT_NULL:
+            # keep the null section first, it has no data
+            offset = 0
+        elif sh_type != SHT_NOBITS and offset + size > len(data):
+            return None
+        sections.append((index, offset, size, align, sh_type, raw))
+    sections.sort(key=lambda s: (s[1], s[0]))
+
+    end = ehsize
+    for section in sections:
+        if section[4] != SHT_NOBITS and section[2]:
+            if section[1] < end:
+                return None
+            end = section[1] + section[2]
+
+    records = ElfRecords(data, endian, is64, bytes(data[:ehsize]), sections, shstrndx)
+    if not len(records):
+        return None
+    return records
+
+
+BITCODE_MAGIC = b'BC\xc0\xde'
+BITCODE_WRAPPER_MAGIC = 0x0B17C0DE
+BITCODE_WRAPPER_SIZE = 20
+BITCODE_ENTER_SUBBLOCK = 1
+
+
+def _read_bits(data, bit, width):
+    value = int.from_bytes(data[bit // 8 : bit // 8 + 8], 'little')
+    return (value >> (bit % 8)) & ((1 << width) - 1)
+
+
+def _read_vbr(data, bit, width):
+    value = 0
+    shift = 0
+    while True:
+        chunk = _read_bits(data, bit, width)
+        bit += width
+        value |= (chunk & ((1 << (width - 1)) - 1)) << shift
+        shift += width - 1
+        if not chunk >> (width - 1):
+            return (value, bit)
+
+
+class BitcodeRecords(Records):
+    def __init__(self, ranges, size, wrapper):
+        super().__init__(ranges, size)
+        # the bitcode wrapper header, whose size field has to follow the removals
+        self.wrapper = wrapper
+
+    def pieces(self, first, last):
+        if self.wrapper is None:
+            return super().pieces(first, last)
+
+        header = bytearray(self.wrapper)
+        (bitcode_size,) = struct.unpack_from('<I', header, 12)
+        bitcode_size -= sum(end - start for start, end in self.ranges[first:last])
+        struct.pack_into('<I', header, 12, bitcode_size)
+        return [bytes(header)] + _remove_ranges(self.ranges[first:last], BITCODE_WRAPPER_SIZE, self.size)
+
+
+def split_bitcode(data):
+    """Split LLVM bitcode into its top-level blocks (identification, module, string table, ...)."""
+    wrapper = None
+    start = 0
+    end = len(data)
+    if len(data) >= BITCODE_WRAPPER_SIZE and struct.unpack_from('<I', data, 0)[0] == BITCODE_WRAPPER_MAGIC:
+        (start, size) = struct.unpack_from('<II', data, 8)
+        if start < BITCODE_WRAPPER_SIZE or start + size > len(data):
+            return None
+        wrapper = bytes(data[:BITCODE_WRAPPER_SIZE])
+        end = start + size
+
+    if bytes(data[start : start + 4]) != BITCODE_MAGIC:
+        return None
+
+    ranges = []
+    # top-level abbreviations are 2 bits wide and every block ends 32-bit aligned
+    pos = start + 4
+    while pos + 4 <= end:
+        if _read_bits(data, pos * 8, 2) != BITCODE_ENTER_SUBBLOCK:
+            break
+        (_, bit) = _read_vbr(data, pos * 8 + 2, 8)
+        (_, bit) = _read_vbr(data, bit, 4)
+        words_pos = (bit + 31) // 32 * 4
+        if words_pos + 4 > end:
+            return None
+        (words,) = struct.unpack_from('<I', data, words_pos)
+        block_end = words_pos + 4 + words * 4
+        if block_end > end:
+            return None
+        ranges.append((pos, block_end))
+        pos = block_end
+
+    if not ranges:
+        return None
+    return BitcodeRecords(ranges, len(data), wrapper)
+
+
+FIXED_FORMAT = re.compile(r'fixed-([0-9]+)$')
+AUTO_BLOCK = 64
+
+SPLITTERS = {
+    'elf': split_elf,
+    'bitcode': split_bitcode,
+    'gcda': split_gcda,
+}
+
+
+def split_auto(data):
+    """Use the first format that recognizes the content, fall back to blocks of AUTO_BLOCK bytes."""
+    for splitter in SPLITTERS.values():
+        records = splitter(data)
+        if records is not None:
+            return records
+    return split_fixed(data, AUTO_BLOCK)
+
+
+def get_splitter(fmt):
+    """Return the splitter for fmt ('fixed-N', 'elf', 'bitcode', 'gcda' or 'auto'), or None if unknown."""
+    if fmt == 'auto':
+        return split_auto
+    m = FIXED_FORMAT.match(fmt)
+    if m and int(m.group(1)) > 0:
+        block = int(m.group(1))
+        return lambda data: split_fixed(data, block)
+    return SPLITTERS.get(fmt)
@@ -1,3 +1,4 @@
+import bisect
 import enum
 import re
 
@@ -17,6 +18,7 @@ class Pattern:
 class RegExPattern(Pattern):
     def __init__(self, expr):
         self.expr = expr
+        self.regex = re.compile(expr, flags=re.DOTALL)
 
     def __repr__(self):
         return f'(expr={self.expr})'
@@ -40,13 +42,56 @@ class OrPattern(Pattern):
         return f'(left={self.left}, right={self.right})'
 
 
-def __get_regex_match(pattern, string, pos=0, search=False):
-    regex = re.compile(pattern.expr, flags=re.DOTALL)
+class BracketPairs:
+    """Positions of all matching start/end bracket pairs of a string, found in a single scan."""
+
+    def __init__(self, start, end, string):
+        self.ends = {}
+        stack = []
+        for m in re.finditer(re.escape(start) + '|' + re.escape(end), string):
+            if m.group() == start:
+                stack.append(m.start())
+            elif stack:
+                self.ends[stack.pop()] = m.end()
+        # openers left on the stack are never closed
+        self.starts = sorted(self.ends)
+
+    def match(self, pos):
+        end = self.ends.get(pos)
+        if end is None:
+            return None
+        return (pos, end)
+
+    def search(self, pos):
+        i = bisect.bisect_left(self.starts, pos)
+        if i == len(self.starts):
+            return None
+        return self.match(self.starts[i])
+
+
+# bracket pairs of the most recently matched string, keyed by (start, end)
+_bracket_cache = (None, {})
+
 
+def __get_bracket_pairs(pattern, string):
+    global _bracket_cache
+
+    (cached_string, pairs) = _bracket_cache
+    if cached_string is not string and cached_string != string:
+        pairs = {}
+        _bracket_cache = (string, pairs)
+
+    key = (pattern.start, pattern.end)
+    if key not in pairs:
+        pairs[key] = BracketPairs(pattern.start, pattern.end, string)
+    return pairs[key]
+
+
+def __get_regex_match(pattern, string, pos=0, search=False):
     if search:
-        m = regex.search(string, pos=pos)
+        m = pattern.regex.search(string, pos=pos)
     else:
-        m = regex.match(string, pos=pos)
+        m = pattern.regex.match(string, pos=pos)
 
     if m is not None:
         return (m.start(), m.end())
@@ -58,46 +103,12 @@ def __get_balanced_match(pattern, string, pos=0, search=False):
     if pos < 0 or pos >= len(string):
         return None
 
-    def __match_helper(pattern, string, pos):
-        start_pos = pos
-        depth = 1
-        pos += len(pattern.start)
-
-        while pos < len(string) and depth > 0:
-            if string[pos].startswith(pattern.start):
-                depth += 1
-                pos += len(pattern.start)
-            elif string[pos].startswith(pattern.end):
-                depth -= 1
-                pos += len(pattern.end)
-            else:
-                pos += 1
-
-        if depth != 0:
-            return None
-
-        return (start_pos, pos)
+    pairs = __get_bracket_pairs(pattern, string)
 
     if search:
-        while pos < len(string):
-            pos = string.find(pattern.start, pos)
-
-            if pos == -1:
-                return None
-
-            m = __match_helper(pattern, string, pos)
-
-            if m is not None:
-                return m
-
-            pos += 1
-
-        return None
+        return pairs.search(pos)
     else:
-        if not string[pos].startswith(pattern.start):
-            return None
-
-        return __match_helper(pattern, string, pos)
+        return pairs.match(pos)
 
 
 def __get_leftmost_match(matches):
@@ -136,6 +147,11 @@ def __unify_part(part):
     return part
 
 
+def _matches_first_part(parts, string, pos):
+    (pattern, _) = __unify_part(parts[0])
+    return __match_pattern(pattern, string, pos=pos) is not None
+
+
 def find(expr, string, pos=0, prefix=''):
     parts = []
 
@@ -193,3 +209,66 @@ def search(parts, string, pos=0, search=True):
         return matches
     else:
         return None
+
+
+class MatchIndex:
+    """Ordered index of the matches of a pattern sequence in a string.
+
+    Matches are found lazily with search() and remembered, so looking up the next match
+    from increasing positions scans the string only once.
+    """
+
+    def __init__(self, parts, string):
+        self.parts = parts
+        self.string = string
+        self.starts = []
+        self.matches = []
+        # all matches starting in [lo, hi) are known
+        self.lo = 0
+        self.hi = 0
+        # (query, start, end): no anchored start in [query, start), all of [start, end] are
+        self.anchored = None
+
+    def next(self, pos):
+        """Return the first match starting at or after pos, or None."""
+        if not self.lo <= pos <= self.hi:
+            self.starts = []
+            self.matches = []
+            self.lo = self.hi = pos
+
+        i = bisect.bisect_left(self.starts, pos)
+        if i < len(self.starts):
+            return self.matches[i]
+
+        m = search(self.parts, self.string, pos=self.hi)
+        if m is None:
+            self.hi = max(self.hi, len(self.string))
+            return None
+
+        self.starts.append(m['all'][0])
+        self.matches.append(m)
+        self.hi = m['all'][0] + 1
+        return m
+
+    def next_anchored(self, pos):
+        """Return the first p >= pos for which search(parts, string, pos=p, search=False) finds a match, or None.
+
+        Such a search walks forward as long as the first part matches in place, so p may
+        precede the start of the match it finds.
+        """
+        if self.anchored is not None:
+            (query, start, end) = self.anchored
+            if query <= pos <= end:
+                return max(pos, start)
+
+        m = self.next(pos)
+        if m is None:
+            return None
+
+        end = m['all'][0]
+        start = end
+        while start > pos and _matches_first_part(self.parts, self.string, start - 1):
+            start -= 1
+
+        self.anchored = (pos, start, end)
+        return start
@@ -0,0 +1,75 @@
+"""Byte ranges of the test case the clang_delta passes are restricted to.
+
+The ranges are given for the original test case and are carried over every
+successful variant: the bytes before the first change and after the last one
+keep their ranges, while a range reaching into the changed bytes is clipped to
+what is left of them.  The bytes between the first and the last change count as
+changed, so a region can grow when a variant changes the test case in several
+places.
+"""
+
+
+def common_prefix(a, b):
+    """Return the length of the longest common prefix of the bytes a and b."""
+    (lo, hi) = (0, min(len(a), len(b)))
+    while lo < hi:
+        mid = (lo + hi + 1) // 2
+        if a[lo:mid] == b[lo:mid]:
+            lo = mid
+        else:
+            hi = mid - 1
+    return lo
+
+
+def common_suffix(a, b, limit):
+    """Return the length of the longest common suffix of a and b, at most limit."""
+    (lo, hi) = (0, min(len(a), len(b), limit))
+    while lo < hi:
+        mid = (lo + hi + 1) // 2
+        if a[len(a) - mid : len(a) - lo] == b[len(b) - mid : len(b) - lo]:
+            lo = mid
+        else:
+            hi = mid - 1
+    return lo
+
+
+class FocusRegions:
+    def __init__(self, regions):
+        # sorted (start, end) byte ranges
+        self.regions = sorted(regions)
+
+    def __repr__(self):
+        return f'FocusRegions({self.regions})'
+
+    @staticmethod
+    def parse(specs):
+        """Create the regions from OFFSET:LENGTH strings."""
+        regions = []
+        for spec in specs:
+            (offset, sep, length) = spec.partition(':')
+            if not sep or not offset.isdigit() or not length.isdigit():
+                raise ValueError(f'invalid region "{spec}", expected OFFSET:LENGTH')
+            regions.append((int(offset), int(offset) + int(length)))
+        return FocusRegions(regions)
+
+    def update(self, before, after):
+        """Map the regions of the content before onto the content after."""
+        prefix = common_prefix(before, after)
+        suffix = common_suffix(before, after, min(len(before), len(after)) - prefix)
+        (changed_end, new_end) = (len(before) - suffix, len(after) - suffix)
+
+        def map_offset(offset, is_end):
+            if offset <= prefix:
+                return offset
+            if offset >= changed_end:
+                return offset - changed_end + new_end
+            return new_end if is_end else prefix
+
+        regions = ((map_offset(start, False), map_offset(end, True)) for (start, end) in self.regions)
+        self.regions = [(start, end) for (start, end) in regions if start < end]
+
+    def clang_delta_args(self):
+        if not self.regions:
+            # an empty region keeps clang_delta away from the whole test case
+            return ['--region=0:0']
+        return [f'--region={start}:{end - start}' for (start, end) in self.regions]
@@ -0,0 +1,181 @@
+"""Create variants of a file by splicing byte ranges of the original content.
+
+The content is never decoded in Python: line boundaries and pattern matches are
+found in one scan of a memory mapping, and a variant is written with vectored
+writes of slices of the mapping; large byte ranges are copied by the kernel
+(copy_file_range or sendfile) where available.
+"""
+
+from array import array
+import mmap
+import os
+import re
+import tempfile
+
+NEWLINE = re.compile(b'\n')
+COPY_CHUNK = 1 << 20
+IOV_MAX = os.sysconf('SC_IOV_MAX') if hasattr(os, 'sysconf') and 'SC_IOV_MAX' in os.sysconf_names else 16
+
+_use_copy_file_range = hasattr(os, 'copy_file_range')
+_use_sendfile = hasattr(os, 'sendfile')
+
+
+def line_offsets(path):
+    """Return an array with the start offsets of all lines of path followed by the file size."""
+    with open(path, 'rb') as f:
+        size = os.fstat(f.fileno()).st_size
+        offsets = array('q', [0])
+        if size:
+            with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+                offsets.extend(m.end() for m in NEWLINE.finditer(data))
+        if offsets[-1] != size:
+            offsets.append(size)
+        return offsets
+
+
+def line_ranges(path, regex):
+    """Return the (start, end) byte ranges of the lines where regex (a bytes pattern) matches at a line start.
+
+    The pattern should be compiled with re.MULTILINE and start with '^'.
+    """
+    ranges = []
+    with open(path, 'rb') as f:
+        size = os.fstat(f.fileno()).st_size
+        if not size:
+            return ranges
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+            for m in regex.finditer(data):
+                if m.start() == size:
+                    # there is no line after the last newline
+                    break
+                end = data.find(b'\n', m.start())
+                ranges.append((m.start(), size if end == -1 else end + 1))
+    return ranges
+
+
+def find_matches(path, regex, replace_fn=None):
+    """Return the (start, end, replacement) edits for all matches of regex (a bytes pattern) in path.
+
+    The replacement is replace_fn(match) or, without replace_fn, empty.
+    """
+    edits = []
+    with open(path, 'rb') as f:
+        if not os.fstat(f.fileno()).st_size:
+            return edits
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as data:
+            for m in regex.finditer(data):
+                edits.append((m.start(), m.end(), b'' if replace_fn is None else replace_fn(m)))
+    return edits
+
+
+def _copy_range(in_fd, out_fd, offset, count):
+    global _use_copy_file_range, _use_sendfile
+
+    while count > 0:
+        copied = 0
+        if _use_copy_file_range:
+            try:
+                copied = os.copy_file_range(in_fd, out_fd, count, offset)
+            except OSError:
+                _use_copy_file_range = False
+        elif _use_sendfile:
+            try:
+                copied = os.sendfile(out_fd, in_fd, offset, count)
+            except OSError:
+                _use_sendfile = False
+
+        if not copied:
+            os.lseek(in_fd, offset, os.SEEK_SET)
+            data = os.read(in_fd, min(count, COPY_CHUNK))
+            if not data:
+                # the range is beyond the end of the file
+                return
+            _write(out_fd, data)
+            copied = len(data)
+
+        offset += copied
+        count -= copied
+
+
+def _write(fd, data):
+    view = memoryview(data)
+    while view:
+        written = os.write(fd, view)
+        view = view[written:]
+
+
+def _writev(fd, buffers):
+    if not hasattr(os, 'writev'):
+        for buffer in buffers:
+            _write(fd, buffer)
+        return
+
+    while buffers:
+        written = os.writev(fd, buffers[:IOV_MAX])
+        while buffers and written >= len(buffers[0]):
+            written -= len(buffers[0])
+            buffers = buffers[1:]
+        if written:
+            buffers = [memoryview(buffers[0])[written:]] + buffers[1:]
+
+
+def _write_pieces(in_fd, out_fd, data, pieces):
+    # small pieces are collected for one vectored write, large ranges are copied by the kernel
+    buffers = []
+    for piece in pieces:
+        if isinstance(piece, bytes):
+            if piece:
+                buffers.append(piece)
+            continue
+        (start, end) = piece
+        if end <= start:
+            continue
+        if data is not None and end - start < COPY_CHUNK:
+            buffers.append(data[start:end])
+        else:
+            _writev(out_fd, buffers)
+            buffers = []
+            _copy_range(in_fd, out_fd, start, end - start)
+    _writev(out_fd, buffers)
+
+
+def splice_file(path, pieces):
+    """Replace the content of path by the concatenation of pieces.
+
+    A piece is either a (start, end) byte range of the current content or a bytes object.
+    """
+    (out_fd, tmp_name) = tempfile.mkstemp(dir=os.path.dirname(path))
+    try:
+        with open(path, 'rb') as src:
+            in_fd = src.fileno()
+            if os.fstat(in_fd).st_size:
+                with mmap.mmap(in_fd, 0, access=mmap.ACCESS_READ) as data:
+                    with memoryview(data) as view:
+                        _write_pieces(in_fd, out_fd, view, pieces)
+            else:
+                _write_pieces(in_fd, out_fd, None, pieces)
+    except BaseException:
+        os.close(out_fd)
+        os.unlink(tmp_name)
+        raise
+    os.close(out_fd)
+    os.replace(tmp_name, path)
+
+
+def remove_ranges(path, ranges, size=None):
+    """Remove the sorted, non-overlapping (start, end) byte ranges from path."""
+    replace_ranges(path, [(start, end, b'') for start, end in ranges], size)
+
+
+def replace_ranges(path, edits, size=None):
+    """Apply the sorted, non-overlapping (start, end, replacement) edits to path."""
+    if size is None:
+        size = os.path.getsize(path)
+    pieces = []
+    pos = 0
+    for start, end, replacement in edits:
+        pieces.append((pos, start))
+        pieces.append(replacement)
+        pos = end
+    pieces.append((pos, size))
+    splice_file(path, pieces)
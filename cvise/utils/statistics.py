@@ -50,3 +50,35 @@ class PassStatistic:
             return (-pass_data.total_seconds, pass_name)
 
         return sorted(self.stats.items(), key=sort_statistics)
+
+
+class TestTierStatistic:
+    def __init__(self, name):
+        self.name = name
+        self.executed = 0
+        self.passed = 0
+        self.total_seconds = 0
+
+    def add(self, exitcode, seconds):
+        self.executed += 1
+        if exitcode == 0:
+            self.passed += 1
+        self.total_seconds += seconds
+
+
+class TestStatistic:
+    """Pass rates and run times of the fast and the full interestingness test."""
+
+    def __init__(self):
+        self.fast = TestTierStatistic('fast test')
+        self.full = TestTierStatistic('full test')
+
+    def add(self, test_env):
+        if test_env.fast_seconds is not None:
+            self.fast.add(test_env.fast_exitcode, test_env.fast_seconds)
+        if test_env.test_seconds is not None:
+            self.full.add(test_env.exitcode, test_env.test_seconds)
+
+    @property
+    def tiers(self):
+        return [self.fast, self.full]
@@ -1,4 +1,5 @@
 from concurrent.futures import FIRST_COMPLETED, wait
+import copy
 import difflib
 import filecmp
 import logging
@@ -7,28 +8,33 @@ from multiprocessing import Manager
 import os
 from pathlib import Path
 import platform
+import re
 import shutil
 import subprocess
 import sys
 import tempfile
+import threading
+import time
 import traceback
 
 from cvise.cvise import CVise
-from cvise.passes.abstract import PassResult, ProcessEventNotifier, ProcessEventType
+from cvise.passes.abstract import PassResult, ProcessEventNotifier, ProcessEventType, ProgressHistory
 from cvise.utils.error import AbsolutePathTestCaseError
 from cvise.utils.error import InsaneTestCaseError
 from cvise.utils.error import InvalidInterestingnessTestError
 from cvise.utils.error import InvalidTestCaseError
 from cvise.utils.error import PassBugError
 from cvise.utils.error import ZeroSizeError
-from cvise.utils.misc import is_readable_file
 from cvise.utils.readkey import KeyLogger
+from cvise.utils.regions import common_prefix, common_suffix
+from cvise.utils.statistics import TestStatistic
 import pebble
 import psutil
 
 # change default Pebble sleep unit for faster response
 pebble.common.SLEEP_UNIT = 0.01
 MAX_PASS_INCREASEMENT_THRESHOLD = 3
+NON_BLANK_LINE = re.compile(rb'^[^\S\n]*\S', flags=re.MULTILINE)
 
 
 def rmfolder(name):
@@ -50,13 +56,21 @@ class TestEnvironment:
         all_test_cases,
         transform,
         pid_queue=None,
+        fast_test_script=None,
     ):
         self.state = state
         self.folder = folder
         self.base_size = None
         self.test_script = test_script
+        self.fast_test_script = fast_test_script
         self.exitcode = None
+        # exit code and run times of the tiers, None for a tier that did not run
+        self.fast_exitcode = None
+        self.fast_seconds = None
+        self.test_seconds = None
         self.result = None
+        # the warnings the pass asked the coordinator to log once
+        self.messages = []
         self.order = order
         self.transform = transform
         self.pid_queue = pid_queue
@@ -87,14 +101,16 @@ class TestEnvironment:
             shutil.copy(self.folder / f, dst)
 
         shutil.copy(self.test_script, dst)
+        if self.fast_test_script is not None:
+            shutil.copy(self.fast_test_script, dst)
 
     def run(self):
         try:
             # transform by state
-            (result, self.state) = self.transform(
-                str(self.test_case_path), self.state, ProcessEventNotifier(self.pid_queue)
-            )
+            notifier = ProcessEventNotifier(self.pid_queue)
+            (result, self.state) = self.transform(str(self.test_case_path), self.state, notifier)
             self.result = result
+            self.messages = notifier.messages
             if self.result != PassResult.OK:
                 return self
 
@@ -110,18 +126,144 @@ class TestEnvironment:
             return self
 
     def run_test(self, verbose):
-        try:
-            os.chdir(self.folder)
-            stdout, stderr, returncode = ProcessEventNotifier(self.pid_queue).run_process(
-                str(self.test_script), shell=True
-            )
-            if verbose and returncode != 0:
-                logging.debug('stdout:\n' + stdout)
-                logging.debug('stderr:\n' + stderr)
-        finally:
-            os.chdir(self.pwd)
+        # the cheap test rejects most of the variants before the full one runs
+        if self.fast_test_script is not None:
+            (self.fast_exitcode, self.fast_seconds) = self.run_script(self.fast_test_script, verbose)
+            if self.fast_exitcode != 0:
+                return self.fast_exitcode
+        (returncode, self.test_seconds) = self.run_script(self.test_script, verbose)
         return returncode
 
+    def run_script(self, script, verbose):
+        start = time.monotonic()
+        # do not chdir, the sanity check can also run in a prefetch thread
+        stdout, stderr, returncode = ProcessEventNotifier(self.pid_queue).run_process(
+            str(script), shell=True, cwd=self.folder
+        )
+        if verbose and returncode != 0:
+            logging.debug('stdout:\n' + stdout)
+            logging.debug('stderr:\n' + stderr)
+        return (returncode, time.monotonic() - start)
+
+
+class PassPrefetch:
+    """Speculatively create the initial states of a pass in a background thread.
+
+    The states are created by a copy of the pass working on a snapshot of the test cases.
+    They can be used only if the test cases are still identical to the snapshot when
+    the pass is started; otherwise they are thrown away.
+    """
+
+    def __init__(self, pass_, test_manager):
+        self.pass_ = pass_
+        self.test_manager = test_manager
+        self.lock = threading.Lock()
+        self.thread = None
+        self.generation = 0
+        self.cancelled = False
+        self.snapshot = None
+        self.result = None
+        self.restart()
+
+    def restart(self):
+        with self.lock:
+            self.generation += 1
+            if self.thread is None:
+                self.thread = threading.Thread(target=self.run, daemon=True)
+                self.thread.start()
+
+    def run(self):
+        while True:
+            with self.lock:
+                generation = self.generation
+                self.result = None
+                self.snapshot = self.test_manager.snapshot_test_cases()
+                snapshot = self.snapshot
+            try:
+                result = self.test_manager.create_speculative_states(self.pass_, snapshot)
+            except Exception as e:
+                logging.debug(f'prefetch of {self.pass_} failed: {e}')
+                result = None
+            with self.lock:
+                self.result = result
+                # start over if the test cases were modified in the meantime
+                if generation == self.generation or self.cancelled:
+                    self.thread = None
+                    return
+
+    def take(self, pass_):
+        """Return (snapshot, {test_case: (state, content, pass copy)}) if usable for pass_, otherwise None."""
+        if pass_ is not self.pass_:
+            self.cancel()
+            return None
+        with self.lock:
+            thread = self.thread
+            snapshot = self.snapshot
+        if thread is not None:
+            # do not wait for a computation that is already known to be useless
+            if snapshot is None or not self.test_manager.matches_snapshot(snapshot):
+                self.cancel()
+                return None
+            thread.join()
+        with self.lock:
+            if self.result is None or not self.test_manager.matches_snapshot(self.snapshot):
+                return None
+            return (self.snapshot, self.result)
+
+    def cancel(self):
+        with self.lock:
+            self.cancelled = True
+
+
+class PassJob:
+    """The reduction of one test case by a pass.
+
+    Every job has its own copy of the pass, as passes keep data about the test case
+    they work on between calls (see AbstractPass.local_cache).
+    """
+
+    def __init__(self, pass_, test_case):
+        self.pass_ = copy.copy(pass_)
+        self.pass_.local_cache = None
+        self.test_case = test_case
+        self.state = None
+        # states generated ahead of their tests, in the order of advance
+        self.pending = []
+        self.generated = 0
+        self.history = ProgressHistory()
+        self.order = 1
+        self.success_count = 0
+        self.starting_size = test_case.stat().st_size
+        self.test_case_before_pass = None
+
+    def has_states(self):
+        return self.state is not None or bool(self.pending)
+
+    def fill_pending(self, lookahead):
+        """Generate the upcoming states until lookahead of them are pending.
+
+        A pass without estimates gets only one pending state, so its states are tested in the order of advance.
+        """
+        while self.state is not None and len(self.pending) < lookahead:
+            if self.pending and self.pending[-1].estimate is None:
+                break
+            estimate = self.pass_.estimate_progress(self.test_case, self.state, self.history)
+            self.pending.append(PendingState(self.generated, self.state, estimate))
+            self.generated += 1
+            self.state = self.pass_.advance(self.test_case, self.state)
+
+
+class PendingState:
+    def __init__(self, seq, state, estimate):
+        # position of the state in the order of advance
+        self.seq = seq
+        self.state = state
+        self.estimate = estimate
+
+    @property
+    def expected_gain(self):
+        return self.estimate.expected_gain if self.estimate is not None else 0
+
 
 class TestManager:
     GIVEUP_CONSTANT = 50000
@@ -149,8 +291,11 @@ class TestManager:
         start_with_pass,
         skip_after_n_transforms,
         stopping_threshold,
+        fast_test=None,
     ):
         self.test_script = Path(test_script).absolute()
+        self.fast_test_script = Path(fast_test).absolute() if fast_test else None
+        self.test_statistic = TestStatistic()
         self.timeout = timeout
         self.save_temps = save_temps
         self.pass_statistic = pass_statistic
@@ -177,11 +322,22 @@ class TestManager:
                 raise AbsolutePathTestCaseError(test_case)
             self.test_cases.add(test_case)
 
+        # sizes, non-blank line counts and undecodable line counts of the test cases, updated
+        # whenever a test case is changed
+        self.file_sizes = {}
+        self.line_counts = {}
+        self.undecodable_lines = {}
+        for test_case in self.test_cases:
+            self.update_file_stats(test_case)
+
         self.orig_total_file_size = self.total_file_size
         self.cache = {}
         self.root = None
-        if not self.is_valid_test(self.test_script):
-            raise InvalidInterestingnessTestError(self.test_script)
+        self.current_pass = None
+        self.prefetch = None
+        for script in (self.test_script, self.fast_test_script):
+            if script is not None and not self.is_valid_test(script):
+                raise InvalidInterestingnessTestError(script)
 
         self.use_colordiff = (
             sys.stdout.isatty()
@@ -216,11 +372,11 @@ class TestManager:
 
     @property
     def total_file_size(self):
-        return self.get_file_size(self.test_cases)
+        return sum(self.file_sizes.values())
 
     @property
     def sorted_test_cases(self):
-        return sorted(self.test_cases, key=lambda x: x.stat().st_size, reverse=True)
+        return sorted(self.test_cases, key=lambda x: self.file_sizes[x], reverse=True)
 
     @staticmethod
     def get_file_size(files):
@@ -228,17 +384,58 @@ class TestManager:
 
     @property
     def total_line_count(self):
-        return self.get_line_count(self.test_cases)
+        # an undecodable test case counts as zero lines
+        return sum(lines for test_case, lines in self.line_counts.items() if not self.undecodable_lines[test_case])
 
-    @staticmethod
-    def get_line_count(files):
+    @classmethod
+    def get_line_count(cls, files):
         lines = 0
         for file in files:
-            if is_readable_file(file):
-                with open(file) as f:
-                    lines += len([line for line in f.readlines() if line and not line.isspace()])
+            (non_blank, undecodable) = cls.count_lines(file.read_bytes())
+            if not undecodable:
+                lines += non_blank
         return lines
 
+    @staticmethod
+    def count_lines(data):
+        """Return the numbers of non-blank lines and of lines that are not valid UTF-8 in data."""
+        try:
+            data.decode()
+            undecodable = 0
+        except UnicodeDecodeError:
+            # a multi-byte sequence never contains a newline, so the lines can be checked one by one
+            undecodable = 0
+            for line in data.split(b'\n'):
+                try:
+                    line.decode()
+                except UnicodeDecodeError:
+                    undecodable += 1
+        return (len(NON_BLANK_LINE.findall(data)), undecodable)
+
+    def update_file_stats(self, test_case, before=None, after=None):
+        """Account for a new content of test_case, only the changed file is read.
+
+        Given the previous content and the new one, only the lines around the changed bytes are counted.
+        """
+        if before is None or test_case not in self.line_counts:
+            data = test_case.read_bytes()
+            self.file_sizes[test_case] = len(data)
+            (self.line_counts[test_case], self.undecodable_lines[test_case]) = self.count_lines(data)
+            return
+
+        prefix = common_prefix(before, after)
+        suffix = common_suffix(before, after, min(len(before), len(after)) - prefix)
+        # extend the changed bytes to whole lines, the same in both contents
+        start = before.rfind(b'\n', 0, prefix) + 1
+        end = before.find(b'\n', len(before) - suffix)
+        end = len(before) if end == -1 else end + 1
+        (old_lines, old_undecodable) = self.count_lines(before[start:end])
+        (new_lines, new_undecodable) = self.count_lines(after[start : end + len(after) - len(before)])
+
+        self.file_sizes[test_case] = len(after)
+        self.line_counts[test_case] += new_lines - old_lines
+        self.undecodable_lines[test_case] += new_undecodable - old_undecodable
+
     def backup_test_cases(self):
         for f in self.test_cases:
             orig_file = Path(f'{f}.orig')
@@ -317,13 +514,27 @@ class TestManager:
 
         return ''.join(diffed_lines)
 
-    def check_sanity(self, verbose=False):
+    def check_sanity(self, verbose=False, contents=None):
         logging.debug('perform sanity check... ')
 
         folder = Path(tempfile.mkdtemp(prefix=f'{self.TEMP_PREFIX}sanity-'))
-        test_env = TestEnvironment(None, 0, self.test_script, folder, list(self.test_cases)[0], self.test_cases, None)
+        test_env = TestEnvironment(
+            None,
+            0,
+            self.test_script,
+            folder,
+            list(self.test_cases)[0],
+            self.test_cases,
+            None,
+            fast_test_script=self.fast_test_script,
+        )
         logging.debug(f'sanity check tmpdir = {test_env.folder}')
 
+        # check the given file contents instead of the current test cases
+        if contents is not None:
+            for test_case, data in contents.items():
+                (folder / test_case).write_bytes(data)
+
         returncode = test_env.run_test(verbose)
         if returncode == 0:
             rmfolder(folder)
@@ -331,7 +542,84 @@ class TestManager:
         else:
             if not self.save_temps:
                 rmfolder(folder)
-            raise InsaneTestCaseError(self.test_cases, self.test_script)
+            # the fast test must accept everything the full test accepts
+            failed_script = self.test_script if test_env.fast_exitcode in (None, 0) else self.fast_test_script
+            raise InsaneTestCaseError(self.test_cases, failed_script)
+
+    def snapshot_test_cases(self):
+        return {test_case: test_case.read_bytes() for test_case in self.test_cases}
+
+    def matches_snapshot(self, snapshot):
+        try:
+            return all(test_case.read_bytes() == data for test_case, data in snapshot.items())
+        except OSError:
+            return False
+
+    def create_speculative_states(self, pass_, snapshot):
+        """Call new() of a copy of pass_ for each test case of the snapshot.
+
+        The test cases are copied to a private folder as new() can modify them (e.g. LinesPass
+        formats the file) and the sanity check is run against the private copies.  Every test
+        case gets its own copy of the pass, as the local_cache set up by new() belongs to it.
+        """
+        folder = Path(tempfile.mkdtemp(prefix=f'{self.TEMP_PREFIX}prefetch-'))
+        states = {}
+        try:
+            for test_case, data in snapshot.items():
+                (folder / test_case).parent.mkdir(parents=True, exist_ok=True)
+                (folder / test_case).write_bytes(data)
+
+            for test_case, data in snapshot.items():
+                if not data:
+                    continue
+                path = folder / test_case
+
+                def check_sanity(path=path, test_case=test_case):
+                    self.check_sanity(contents={**snapshot, test_case: path.read_bytes()})
+
+                speculative_pass = copy.copy(pass_)
+                speculative_pass.local_cache = None
+                state = speculative_pass.new(path, check_sanity)
+                states[test_case] = (state, path.read_bytes(), speculative_pass)
+                # later test cases see the original content of this one
+                path.write_bytes(data)
+        finally:
+            rmfolder(folder)
+
+        return states
+
+    def prefetch_pass(self, pass_):
+        if pass_ is None or pass_ is self.current_pass or self.parallel_tests <= 1:
+            return
+        if self.prefetch is not None and self.prefetch.pass_ is pass_:
+            self.prefetch.restart()
+        else:
+            if self.prefetch is not None:
+                self.prefetch.cancel()
+            self.prefetch = PassPrefetch(pass_, self)
+
+    def take_prefetched_states(self, pass_):
+        prefetch, self.prefetch = self.prefetch, None
+        if prefetch is None:
+            return None
+        result = prefetch.take(pass_)
+        if result is None:
+            logging.debug(f'discarding speculative initial states of {pass_}')
+            return None
+        return result
+
+    def create_state(self, job, prefetched):
+        test_case = job.test_case
+        # a speculative state is valid only if no test case has changed since the snapshot
+        if prefetched is not None and test_case in prefetched[1] and self.matches_snapshot(prefetched[0]):
+            (state, data, speculative_pass) = prefetched[1][test_case]
+            if test_case.read_bytes() != data:
+                test_case.write_bytes(data)
+            logging.debug(f'using speculative initial state for {test_case}')
+            # the copy keeps the attributes computed by new() (e.g. the detected C++ standard)
+            job.pass_ = speculative_pass
+            return state
+        return job.pass_.new(test_case, self.check_sanity)
 
     def release_folder(self, future):
         name = self.temporary_folders.pop(future)
@@ -389,6 +677,7 @@ class TestManager:
                 continue
 
             if future.done():
+                job = self.scheduled[future][0]
                 if future.exception():
                     if type(future.exception()) is TimeoutError:
                         self.timeout_count += 1
@@ -396,20 +685,32 @@ class TestManager:
                         self.save_extra_dir(self.temporary_folders[future])
                         if self.timeout_count >= self.MAX_TIMEOUTS:
                             logging.warning('Maximum number of timeout were reached: %d' % self.MAX_TIMEOUTS)
+                            self.stopped_jobs.add(job)
                             quit_loop = True
                         continue
                     else:
                         raise future.exception()
 
                 test_env = future.result()
+                self.test_statistic.add(test_env)
+                for message in test_env.messages:
+                    if message not in self.reported_messages:
+                        self.reported_messages.add(message)
+                        logging.warning(message)
+                pending = self.scheduled[future][1]
+                if pending.estimate is not None and test_env.result == PassResult.OK:
+                    job.history.record(pending.estimate.key, test_env.success)
                 if test_env.success:
                     if self.max_improvement is not None and test_env.size_improvement > self.max_improvement:
                         logging.debug(f'Too large improvement: {test_env.size_improvement} B')
+                        self.rejected_futures.add(future)
                     else:
                         # Report bug if transform did not change the file
-                        if filecmp.cmp(self.current_test_case, test_env.test_case_path):
+                        if filecmp.cmp(job.test_case, test_env.test_case_path):
+                            self.rejected_futures.add(future)
                             if not self.silent_pass_bug:
                                 if not self.report_pass_bug(test_env, 'pass failed to modify the variant'):
+                                    self.stopped_jobs.add(job)
                                     quit_loop = True
                         else:
                             quit_loop = True
@@ -418,16 +719,24 @@ class TestManager:
                     self.pass_statistic.add_failure(self.current_pass)
                     if test_env.result == PassResult.OK:
                         assert test_env.exitcode
-                        if self.also_interesting is not None and test_env.exitcode == self.also_interesting:
+                        job.pass_.on_failure(job.test_case, test_env.state)
+                        if (
+                            self.also_interesting is not None
+                            and test_env.fast_exitcode in (None, 0)
+                            and test_env.exitcode == self.also_interesting
+                        ):
                             self.save_extra_dir(test_env.test_case_path)
                     elif test_env.result == PassResult.STOP:
+                        self.stopped_jobs.add(job)
                         quit_loop = True
                     elif test_env.result == PassResult.ERROR:
                         if not self.silent_pass_bug:
                             self.report_pass_bug(test_env, 'pass error')
+                            self.stopped_jobs.add(job)
                             quit_loop = True
                     if not self.no_give_up and test_env.order > self.GIVEUP_CONSTANT:
                         self.report_pass_bug(test_env, 'pass got stuck')
+                        self.stopped_jobs.add(job)
                         quit_loop = True
             else:
                 new_futures.add(future)
@@ -453,58 +762,123 @@ class TestManager:
         pool.stop()
         pool.join()
 
-    def run_parallel_tests(self):
+    @staticmethod
+    def was_tested(future):
+        """Return True if the test of future has run to the end without success."""
+        if not future.done() or future.cancelled():
+            return False
+        if future.exception() is not None:
+            return type(future.exception()) is TimeoutError
+        return not future.result().success
+
+    def rewind_jobs(self, success):
+        """Give the states whose tests did not run (or whose success was not taken) back to their jobs.
+
+        All the scheduled futures are checked, as the cancelled ones are already released.
+        """
+        success_job = self.jobs[success.test_case] if success else None
+        rewound = {success_job}
+        for job in self.stopped_jobs:
+            if job is not success_job:
+                job.state = None
+                job.pending.clear()
+                rewound.add(job)
+        for future, (job, pending) in self.scheduled.items():
+            if job not in rewound and future not in self.rejected_futures and not self.was_tested(future):
+                job.pending.append(pending)
+        for job in self.jobs.values():
+            job.pending.sort(key=lambda pending: pending.seq)
+
+    @staticmethod
+    def pick_pending_state(jobs, turn):
+        """Return the job and the index of the pending state with the highest expected gain.
+
+        Ties go to the jobs in turn order, then to the order of advance.
+        """
+        best = None
+        for i in range(len(jobs)):
+            job = jobs[(turn + i) % len(jobs)]
+            for index, pending in enumerate(job.pending):
+                if best is None or pending.expected_gain > best[0]:
+                    best = (pending.expected_gain, job, index)
+        return best[1:]
+
+    def run_parallel_tests(self, jobs):
+        """Test the states of the jobs, taking turns, until a test succeeds, a job stops or all states are used.
+
+        Interleaving the jobs keeps all the workers busy even if every test case has only
+        a few states.  At most one successful variant is returned, so the results are
+        applied to the test cases one by one.
+
+        Everything scheduled after the first success is cancelled, so when the pass estimates
+        its states, each free worker takes the pending state with the highest expected gain
+        out of the next parallel_tests states of every job.
+        """
         assert not self.futures
         assert not self.temporary_folders
+        self.scheduled = {}
+        # the successful futures whose variants were not taken
+        self.rejected_futures = set()
+        self.stopped_jobs = set()
         with pebble.ProcessPool(max_workers=self.parallel_tests) as pool:
-            order = 1
             self.timeout_count = 0
-            while self.state is not None:
+            active = list(jobs)
+            turn = 0
+            while active:
                 # do not create too many states
                 if len(self.futures) >= self.parallel_tests:
                     wait(self.futures, return_when=FIRST_COMPLETED)
 
-                quit_loop = self.process_done_futures()
-                if quit_loop:
-                    success = self.wait_for_first_success()
-                    self.terminate_all(pool)
-                    return success
+                if self.process_done_futures():
+                    break
 
+                for job in active:
+                    job.fill_pending(self.parallel_tests)
+                (job, index) = self.pick_pending_state(active, turn)
+                pending = job.pending.pop(index)
                 folder = Path(tempfile.mkdtemp(prefix=self.TEMP_PREFIX, dir=self.root))
                 test_env = TestEnvironment(
-                    self.state,
-                    order,
+                    pending.state,
+                    job.order,
                     self.test_script,
                     folder,
-                    self.current_test_case,
+                    job.test_case,
                     self.test_cases,
-                    self.current_pass.transform,
+                    job.pass_.transform,
                     self.pid_queue,
+                    self.fast_test_script,
                 )
                 future = pool.schedule(test_env.run, timeout=self.timeout)
                 self.temporary_folders[future] = folder
                 self.futures.append(future)
+                self.scheduled[future] = (job, pending)
                 self.pass_statistic.add_executed(self.current_pass)
-                order += 1
-                state = self.current_pass.advance(self.current_test_case, self.state)
-                # we are at the end of enumeration
-                if state is None:
-                    success = self.wait_for_first_success()
-                    self.terminate_all(pool)
-                    return success
+                job.order += 1
+                # we are at the end of enumeration of this job, the next one takes its turn
+                if not job.has_states():
+                    active.remove(job)
                 else:
-                    self.state = state
+                    turn += 1
 
-    def run_pass(self, pass_):
+            success = self.wait_for_first_success()
+            self.terminate_all(pool)
+        self.rewind_jobs(success)
+        return success
+
+    def run_pass(self, pass_, next_pass=None):
         if self.start_with_pass:
             if self.start_with_pass == str(pass_):
                 self.start_with_pass = None
             else:
                 return
 
+        prefetched = self.take_prefetched_states(pass_)
         self.current_pass = pass_
+        # prepare the next pass while this one keeps the workers busy
+        self.prefetch_pass(next_pass)
         self.futures = []
         self.temporary_folders = {}
+        self.reported_messages = set()
         m = Manager()
         self.pid_queue = m.Queue()
         self.create_root()
@@ -520,75 +894,85 @@ class TestManager:
             logger = KeyLogger()
 
         try:
+            jobs = []
             for test_case in self.sorted_test_cases:
-                self.current_test_case = test_case
-                starting_test_case_size = test_case.stat().st_size
-                success_count = 0
-
-                if self.get_file_size([test_case]) == 0:
+                if self.file_sizes[test_case] == 0:
                     continue
 
+                job = PassJob(pass_, test_case)
                 if not self.no_cache:
                     with open(test_case, mode='rb+') as tmp_file:
-                        test_case_before_pass = tmp_file.read()
+                        job.test_case_before_pass = tmp_file.read()
 
-                        if pass_key in self.cache and test_case_before_pass in self.cache[pass_key]:
+                        if pass_key in self.cache and job.test_case_before_pass in self.cache[pass_key]:
                             tmp_file.seek(0)
                             tmp_file.truncate(0)
-                            tmp_file.write(self.cache[pass_key][test_case_before_pass])
+                            tmp_file.write(self.cache[pass_key][job.test_case_before_pass])
+                            tmp_file.flush()
+                            self.update_file_stats(test_case)
                             logging.info(f'cache hit for {test_case}')
                             continue
 
                 # create initial state
-                self.state = self.current_pass.new(self.current_test_case, self.check_sanity)
-                self.skip = False
-
-                while self.state is not None and not self.skip:
-                    # Ignore more key presses after skip has been detected
-                    if not self.skip_key_off and not self.skip:
-                        key = logger.pressed_key()
-                        if key == 's':
-                            self.skip = True
-                            self.log_key_event('skipping the rest of this pass')
-                        elif key == 'd':
-                            self.log_key_event('toggle print diff')
-                            self.print_diff = not self.print_diff
-
-                    success_env = self.run_parallel_tests()
-                    self.kill_pid_queue()
-
-                    if success_env:
-                        self.process_result(success_env)
-                        success_count += 1
+                job.state = self.create_state(job, prefetched)
+                # new() may have changed the test case (e.g. LinesPass formats it)
+                self.update_file_stats(test_case)
+                jobs.append(job)
+
+            self.jobs = {job.test_case: job for job in jobs}
+            skip = False
+            active = [job for job in jobs if job.has_states()]
+            while active and not skip:
+                # Ignore more key presses after skip has been detected
+                if not self.skip_key_off:
+                    key = logger.pressed_key()
+                    if key == 's':
+                        skip = True
+                        self.log_key_event('skipping the rest of this pass')
+                    elif key == 'd':
+                        self.log_key_event('toggle print diff')
+                        self.print_diff = not self.print_diff
+
+                success_env = self.run_parallel_tests(active)
+                self.kill_pid_queue()
+
+                if success_env:
+                    job = self.jobs[success_env.test_case]
+                    self.process_result(job, success_env)
+                    job.success_count += 1
+                    for other in jobs:
+                        if other is not job:
+                            other.pass_.on_other_success(other.test_case)
+                    self.prefetch_pass(next_pass)
 
                     # if the file increases significantly, bail out the current pass
-                    test_case_size = self.current_test_case.stat().st_size
-                    if test_case_size >= MAX_PASS_INCREASEMENT_THRESHOLD * starting_test_case_size:
+                    test_case_size = self.file_sizes[job.test_case]
+                    if test_case_size >= MAX_PASS_INCREASEMENT_THRESHOLD * job.starting_size:
                         logging.info(
-                            f'skipping the rest of the pass (huge file increasement '
+                            f'skipping the rest of the pass for {job.test_case} (huge file increasement '
                             f'{MAX_PASS_INCREASEMENT_THRESHOLD * 100}%)'
                         )
-                        break
-
-                    self.release_folders()
-                    self.futures.clear()
-                    if not success_env:
-                        break
+                        job.state = None
 
                     # skip after N transformations if requested
-                    if (self.skip_after_n_transforms and success_count >= self.skip_after_n_transforms) or (
-                        self.current_pass.max_transforms and success_count >= self.current_pass.max_transforms
+                    if (self.skip_after_n_transforms and job.success_count >= self.skip_after_n_transforms) or (
+                        self.current_pass.max_transforms and job.success_count >= self.current_pass.max_transforms
                     ):
-                        logging.info(f'skipping after {success_count} successful transformations')
-                        break
+                        logging.info(f'skipping after {job.success_count} successful transformations')
+                        job.state = None
 
-                # Cache result of this pass
-                if not self.no_cache:
-                    with open(test_case, mode='rb') as tmp_file:
+                self.release_folders()
+                self.futures.clear()
+                active = [job for job in jobs if job.has_states()]
+
+            # Cache result of this pass
+            if not self.no_cache:
+                for job in jobs:
+                    with open(job.test_case, mode='rb') as tmp_file:
                         if pass_key not in self.cache:
                             self.cache[pass_key] = {}
 
-                        self.cache[pass_key][test_case_before_pass] = tmp_file.read()
+                        self.cache[pass_key][job.test_case_before_pass] = tmp_file.read()
 
             self.restore_mode()
             self.pass_statistic.stop(self.current_pass)
@@ -598,21 +982,28 @@ class TestManager:
             self.remove_root()
             sys.exit(1)
 
-    def process_result(self, test_env):
+    def process_result(self, job, test_env):
         if self.print_diff:
-            diff_str = self.diff_files(self.current_test_case, test_env.test_case_path)
+            diff_str = self.diff_files(job.test_case, test_env.test_case_path)
             if self.use_colordiff:
                 diff_str = subprocess.check_output('colordiff', shell=True, encoding='utf8', input=diff_str)
             logging.info(diff_str)
 
         try:
-            shutil.copy(test_env.test_case_path, self.current_test_case)
+            before = Path(job.test_case).read_bytes()
+            after = Path(test_env.test_case_path).read_bytes()
+            if job.pass_.focus_regions is not None:
+                job.pass_.focus_regions.update(before, after)
+            shutil.copy(test_env.test_case_path, job.test_case)
         except FileNotFoundError:
             raise RuntimeError(
-                f"Can't find {self.current_test_case} -- did your interestingness test move it?"
+                f"Can't find {job.test_case} -- did your interestingness test move it?"
             ) from None
 
-        self.state = self.current_pass.advance_on_success(test_env.test_case_path, test_env.state)
+        self.update_file_stats(job.test_case, before, after)
+        # the pending states were generated for the previous content
+        job.pending.clear()
+        job.state = job.pass_.advance_on_success(test_env.test_case_path, test_env.state)
         self.pass_statistic.add_success(self.current_pass)
 
         pct = 100 - (self.total_file_size * 100.0 / self.orig_total_file_size)
@@ -25,3 +25,17 @@ class TestCvise(unittest.TestCase):
             '-c "gcc -c blocksort-part.c && grep nextHi blocksort-part.c"',
             ['#define nextHi', '#define  nextHi '],
         )
+
+    def test_print_reduced_test_case(self):
+        testcase = 'print-reduced.c'
+        with open(testcase, 'w') as f:
+            f.write('int foo;\nint bar;\n')
+        current = os.path.dirname(__file__)
+        binary = os.path.join(current, '../cvise.py')
+        proc = subprocess.run(
+            [binary, testcase, '-c', f'grep foo {testcase}'], encoding='utf8', capture_output=True, check=True
+        )
+        # the reduced test case is listed after the reduction
+        assert f'--- {testcase} ---' in proc.stdout
+        assert 'Reduced test-cases:' in proc.stderr
+        assert 'foo' in proc.stderr.split('Reduced test-cases:')[1]